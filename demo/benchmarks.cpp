@@ -0,0 +1,235 @@
+#include <rock/Blueprint.hpp>
+#include <rock/RenderQueue.hpp>
+#include <rock/RoundedRect.hpp>
+#include <rock/ThreadPool.hpp>
+
+#include <Geode/loader/Mod.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+using namespace cocos2d;
+using namespace rock;
+
+template <typename F>
+static double measure(int iterations, F&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// a panel with a grid of rounded buttons, built both ways
+constexpr int GRID_ROWS = 20;
+constexpr int GRID_COLUMNS = 25;
+
+static CCNode* buildProcedural() {
+    auto root = CCNode::create();
+    root->setContentSize({500.f, 400.f});
+
+    for (int row = 0; row < GRID_ROWS; ++row) {
+        auto line = RoundedRect::create({30, 30, 30, 255}, 8.f, {500.f, 20.f});
+        line->setPosition({250.f, 10.f + row * 20.f});
+        root->addChild(line);
+
+        for (int col = 0; col < GRID_COLUMNS; ++col) {
+            auto cell = RoundedRect::create(
+                {GLubyte(col * 10), GLubyte(row * 12), 200, 255},
+                {6.f, 2.f, 6.f, 2.f},
+                {18.f, 18.f}
+            );
+            cell->setPosition({10.f + col * 20.f, 10.f});
+            line->addChild(cell);
+        }
+    }
+
+    return root;
+}
+
+static std::unique_ptr<Blueprint> buildBlueprint() {
+    blueprint::Writer writer;
+
+    blueprint::NodeRecord root;
+    root.width = 500.f;
+    root.height = 400.f;
+    root.childCount = GRID_ROWS;
+    writer.addNode(root);
+
+    for (int row = 0; row < GRID_ROWS; ++row) {
+        blueprint::NodeRecord line;
+        line.type = blueprint::NodeType::RoundedRect;
+        std::ranges::copy(std::array<uint8_t, 4>{30, 30, 30, 255}, line.color);
+        std::ranges::fill(line.radii, 8.f);
+        line.width = 500.f;
+        line.height = 20.f;
+        line.x = 250.f;
+        line.y = 10.f + row * 20.f;
+        line.childCount = GRID_COLUMNS;
+        writer.addNode(line);
+
+        for (int col = 0; col < GRID_COLUMNS; ++col) {
+            blueprint::NodeRecord cell;
+            cell.type = blueprint::NodeType::RoundedRect;
+            std::ranges::copy(std::array<uint8_t, 4>{uint8_t(col * 10), uint8_t(row * 12), 200, 255}, cell.color);
+            std::ranges::copy(std::array{6.f, 2.f, 6.f, 2.f}, cell.radii);
+            cell.width = 18.f;
+            cell.height = 18.f;
+            cell.x = 10.f + col * 20.f;
+            cell.y = 10.f;
+            writer.addNode(cell);
+        }
+    }
+
+    return Blueprint::loadFromMemory(writer.finish());
+}
+
+static void benchmarkBlueprints() {
+    constexpr int ITERATIONS = 50;
+
+    auto blueprint = buildBlueprint();
+    if (!blueprint) return;
+
+    // autoreleased trees are freed at the end of the frame, retain nothing
+    auto procedural = measure(ITERATIONS, [] { buildProcedural(); });
+    auto instantiated = measure(ITERATIONS, [&] { blueprint->instantiate(); });
+
+    geode::log::info(
+        "Blueprint: {} nodes, procedural {:.3f}ms, blueprint {:.3f}ms per tree",
+        blueprint->getNodes().size(), procedural, instantiated
+    );
+}
+
+// overlapping rects covering the whole screen, so fragment cost dominates
+static CCNode* buildOverdrawScene(CCSize const& size) {
+    constexpr int COUNT = 2000;
+
+    auto root = CCNode::create();
+    for (int i = 0; i < COUNT; ++i) {
+        auto rect = RoundedRect::create(
+            {255, 255, 255, 40},
+            Radii(24.f, 8.f, 24.f, 8.f),
+            {size.width * 0.3f, size.height * 0.3f}
+        );
+        rect->setPosition({
+            size.width * static_cast<float>((i * 37) % 100) / 100.f,
+            size.height * static_cast<float>((i * 61) % 100) / 100.f
+        });
+        root->addChild(rect);
+    }
+
+    return root;
+}
+
+static double measureRender(CCRenderTexture* target, CCNode* scene, int iterations) {
+    auto render = [&] {
+        target->beginWithClear(0.f, 0.f, 0.f, 0.f);
+        scene->visit();
+        target->end();
+        // wait for the GPU, otherwise only the submission is measured
+        glFinish();
+    };
+
+    // first frame compiles the programs
+    render();
+    return measure(iterations, render);
+}
+
+static void benchmarkAntiAliasing() {
+    constexpr int ITERATIONS = 30;
+
+    auto winSize = CCDirector::get()->getWinSize();
+    auto target = CCRenderTexture::create(winSize.width, winSize.height);
+    auto scene = buildOverdrawScene(winSize);
+    if (!target || !scene) return;
+
+    auto previous = getDefaultAntiAliasMode();
+
+    setDefaultAntiAliasMode(AntiAliasMode::Derivative);
+    auto derivative = measureRender(target, scene, ITERATIONS);
+
+    setDefaultAntiAliasMode(AntiAliasMode::Analytic);
+    auto analytic = measureRender(target, scene, ITERATIONS);
+
+    setDefaultAntiAliasMode(previous);
+
+    geode::log::info(
+        "Anti-aliasing: {} rects, derivative {:.3f}ms, analytic {:.3f}ms per frame",
+        scene->getChildrenCount(), derivative, analytic
+    );
+}
+
+// lots of small rotated rects that all fit into a single batch, so vertex generation dominates
+static CCNode* buildBatchScene(CCSize const& size) {
+    constexpr int COUNT = 16000;
+
+    auto root = CCNode::create();
+    for (int i = 0; i < COUNT; ++i) {
+        auto rect = RoundedRect::create({GLubyte(i % 256), 120, 200, 255}, 3.f, {12.f, 8.f});
+        rect->setPosition({
+            size.width * static_cast<float>((i * 37) % 1000) / 1000.f,
+            size.height * static_cast<float>((i * 61) % 1000) / 1000.f
+        });
+        rect->setRotation(static_cast<float>(i % 360));
+        root->addChild(rect);
+    }
+
+    return root;
+}
+
+static void benchmarkVertexGeneration() {
+    constexpr int ITERATIONS = 30;
+
+    auto winSize = CCDirector::get()->getWinSize();
+    auto target = CCRenderTexture::create(winSize.width, winSize.height);
+    auto scene = buildBatchScene(winSize);
+    if (!target || !scene) return;
+
+    auto queue = RenderQueue::get();
+    auto wasEnabled = queue->isEnabled();
+    auto previousThreads = queue->getMaxThreads();
+    queue->setEnabled(true);
+
+    // no glFinish, only the CPU side of a frame changes with the amount of threads
+    auto render = [&] {
+        target->beginWithClear(0.f, 0.f, 0.f, 0.f);
+        scene->visit();
+        target->end();
+    };
+    render();
+
+    double serial = 0.0;
+    auto maxThreads = ThreadPool::get()->getThreadCount() + 1;
+    for (size_t threads = 1; threads <= maxThreads; ++threads) {
+        queue->setMaxThreads(threads);
+        auto time = measure(ITERATIONS, render);
+        if (threads == 1) serial = time;
+
+        geode::log::info(
+            "Vertex generation: {} rects, {} threads {:.3f}ms per frame ({:.2f}x)",
+            scene->getChildrenCount(), threads, time, serial / time
+        );
+    }
+
+    queue->setMaxThreads(previousThreads);
+    queue->setEnabled(wasEnabled);
+}
+
+#include <Geode/modify/MenuLayer.hpp>
+class $modify(BenchmarkMenuLayer, MenuLayer) {
+    bool init() override {
+        if (!MenuLayer::init()) return false;
+
+        static bool s_ran = false;
+        if (!s_ran && geode::Mod::get()->getSettingValue<bool>("run-benchmarks")) {
+            s_ran = true;
+            benchmarkBlueprints();
+            benchmarkAntiAliasing();
+            benchmarkVertexGeneration();
+        }
+
+        return true;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include <cocos2d.h>
+#include <rock/BlueprintFormat.hpp>
+
+#include <memory>
+#include <span>
+
+namespace rock {
+    /// @brief A UI layout loaded from a binary blueprint file (see BlueprintFormat.hpp),
+    /// which can be instantiated into a node tree any amount of times.
+    /// Files are memory-mapped when possible, and records are read in place without parsing.
+    /// @note Use the rock-blueprint tool to convert text layouts into blueprints
+    class Blueprint {
+    public:
+        ~Blueprint();
+
+        Blueprint(Blueprint const&) = delete;
+        Blueprint& operator=(Blueprint const&) = delete;
+
+        /// @brief Load a blueprint file
+        /// @param filename Path to the blueprint, resolved with CCFileUtils
+        /// @return Loaded blueprint, or nullptr if the file is missing or invalid
+        static std::unique_ptr<Blueprint> load(char const* filename);
+
+        /// @brief Load a blueprint from memory
+        /// @param data Blueprint contents
+        /// @return Loaded blueprint, or nullptr if the data is invalid
+        static std::unique_ptr<Blueprint> loadFromMemory(std::vector<uint8_t> data);
+
+        /// @brief Create the node tree described by the blueprint
+        /// @return Root node of the tree (autoreleased)
+        cocos2d::CCNode* instantiate() const;
+
+        /// @brief Get node records of the blueprint, in pre-order
+        /// @return Node records
+        std::span<blueprint::NodeRecord const> getNodes() const;
+
+    protected:
+        Blueprint() = default;
+
+        bool validate();
+        char const* getString(uint32_t offset) const;
+        cocos2d::CCNode* createNode(blueprint::NodeRecord const& record) const;
+
+        uint8_t const* m_data = nullptr;
+        size_t m_size = 0;
+        std::vector<uint8_t> m_buffer;
+        void* m_mapping = nullptr;
+        blueprint::NodeRecord const* m_nodes = nullptr;
+        uint32_t m_nodeCount = 0;
+        char const* m_strings = nullptr;
+        uint32_t m_stringsSize = 0;
+    };
+} // namespace rock
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/// Binary layout of rock blueprint files. This header doesn't depend on cocos2d,
+/// so it can be used by offline tools as well.
+///
+/// File layout (all values little-endian, sections 4-byte aligned):
+///   Header
+///   NodeRecord[nodeCount]  - nodes in pre-order, each followed by its `childCount` children
+///   char[stringsSize]      - null-terminated strings, referenced by offset
+namespace rock::blueprint {
+    static_assert(std::endian::native == std::endian::little, "Blueprints are read in place, big-endian is not supported");
+
+    constexpr uint32_t MAGIC = 0x4B434F52; // "ROCK"
+    constexpr uint16_t VERSION = 1;
+    constexpr uint32_t NO_STRING = 0xFFFFFFFF;
+
+    enum class NodeType : uint8_t {
+        Node = 0,
+        RoundedRect = 1,
+        RoundedSprite = 2,
+    };
+
+    struct Header {
+        uint32_t magic = MAGIC;
+        uint16_t version = VERSION;
+        uint16_t reserved = 0;
+        uint32_t nodeCount = 0;
+        uint32_t nodesOffset = 0;
+        uint32_t stringsOffset = 0;
+        uint32_t stringsSize = 0;
+    };
+
+    struct NodeRecord {
+        NodeType type = NodeType::Node;
+        uint8_t color[4] = {255, 255, 255, 255};
+        uint8_t reserved[3] = {};
+        uint32_t childCount = 0;
+        int32_t zOrder = 0;
+        int32_t tag = -1;
+        /// @brief Sprite frame name (or image file), as an offset into the string table
+        uint32_t frameName = NO_STRING;
+        float x = 0.f;
+        float y = 0.f;
+        float scaleX = 1.f;
+        float scaleY = 1.f;
+        float rotation = 0.f;
+        float anchorX = 0.5f;
+        float anchorY = 0.5f;
+        /// @brief Content size, ignored for sprites
+        float width = 0.f;
+        float height = 0.f;
+        /// @brief Corner radii: top-left, top-right, bottom-right, bottom-left
+        float radii[4] = {};
+    };
+
+    static_assert(sizeof(Header) == 24 && std::is_trivially_copyable_v<Header>);
+    static_assert(sizeof(NodeRecord) == 76 && std::is_trivially_copyable_v<NodeRecord>);
+
+    /// @brief Serializes nodes into the blueprint format
+    class Writer {
+    public:
+        /// @brief Add a node. Nodes must be added in pre-order, each followed by its `childCount` children
+        /// @param record Node to add. frameName is filled in by the writer
+        /// @param frameName Sprite frame name, or empty for none
+        void addNode(NodeRecord record, std::string_view frameName = {}) {
+            record.frameName = NO_STRING;
+            if (!frameName.empty()) {
+                record.frameName = static_cast<uint32_t>(m_strings.size());
+                m_strings.insert(m_strings.end(), frameName.begin(), frameName.end());
+                m_strings.push_back('\0');
+            }
+            m_nodes.push_back(record);
+        }
+
+        /// @brief Get the serialized blueprint
+        /// @return Blueprint file contents
+        std::vector<uint8_t> finish() const {
+            Header header;
+            header.nodeCount = static_cast<uint32_t>(m_nodes.size());
+            header.nodesOffset = sizeof(Header);
+            header.stringsOffset = header.nodesOffset + static_cast<uint32_t>(m_nodes.size() * sizeof(NodeRecord));
+            header.stringsSize = static_cast<uint32_t>(m_strings.size());
+
+            std::vector<uint8_t> data(header.stringsOffset + header.stringsSize);
+            std::memcpy(data.data(), &header, sizeof(Header));
+            if (!m_nodes.empty()) {
+                std::memcpy(data.data() + header.nodesOffset, m_nodes.data(), m_nodes.size() * sizeof(NodeRecord));
+            }
+            if (!m_strings.empty()) {
+                std::memcpy(data.data() + header.stringsOffset, m_strings.data(), m_strings.size());
+            }
+            return data;
+        }
+
+    private:
+        std::vector<NodeRecord> m_nodes;
+        std::vector<char> m_strings;
+    };
+} // namespace rock::blueprint
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#include <cocos2d.h>
+#include <rock/NodePool.hpp>
+
+namespace rock {
+    /// @brief A container that renders its children into an offscreen texture once,
+    /// and then draws them as a single quad until something changes
+    /// @note Rock components invalidate their CachedNode ancestors automatically.
+    /// Changes to other nodes require a manual call to invalidate().
+    /// Translucent children that blend with GL_SRC_ALPHA as the source factor (e.g. CCLayerColor)
+    /// store squared alpha in the surface and look more transparent once cached, rock components aren't affected
+    class CachedNode : public cocos2d::CCNode {
+    public:
+        ROCK_POOLED_NODE(CachedNode)
+
+        CachedNode();
+        ~CachedNode() override;
+
+        /// @brief Create a CachedNode with specified size
+        /// @param size Size of the cached area. Children outside of it are clipped
+        static CachedNode* create(cocos2d::CCSize const& size);
+
+        /// @brief Create a CachedNode using window size
+        static CachedNode* create();
+
+        /// @brief Mark the cached texture as outdated, so it gets redrawn on the next visit
+        void invalidate();
+
+        /// @brief Check whether the cached texture will be redrawn on the next visit
+        /// @return True if the cache is outdated
+        bool isDirty() const;
+
+        /// @brief Enable or disable caching. When disabled, children are drawn directly
+        /// @param enabled Whether caching should be used
+        void setCachingEnabled(bool enabled);
+
+        /// @brief Check whether caching is enabled
+        /// @return True if caching is enabled
+        bool isCachingEnabled() const;
+
+        /// @brief Invalidate every CachedNode that contains the given node.
+        /// Returns right away while no CachedNode exists
+        /// @param node Node that has changed
+        static void invalidateAncestors(cocos2d::CCNode* node);
+
+        /// @brief Set the maximum amount of memory all offscreen surfaces can use combined.
+        /// Nodes that don't fit into the budget draw their children directly
+        /// @param bytes Memory budget in bytes
+        static void setMemoryBudget(size_t bytes);
+
+        /// @brief Get the maximum amount of memory all offscreen surfaces can use combined
+        /// @return Memory budget in bytes
+        static size_t getMemoryBudget();
+
+        /// @brief Get the amount of memory currently used by offscreen surfaces
+        /// @return Memory usage in bytes
+        static size_t getMemoryUsage();
+
+    protected:
+        bool init(cocos2d::CCSize const& size);
+
+        bool ensureSurface();
+        void releaseSurface();
+        void renderCache();
+
+    public:
+        using CCNode::addChild;
+
+        void visit() override;
+        void onExit() override;
+        void setContentSize(cocos2d::CCSize const& contentSize) override;
+        void addChild(cocos2d::CCNode* child, int zOrder, int tag) override;
+        void removeChild(cocos2d::CCNode* child, bool cleanup) override;
+        void removeAllChildrenWithCleanup(bool cleanup) override;
+        void reorderChild(cocos2d::CCNode* child, int zOrder) override;
+
+    protected:
+        cocos2d::CCRenderTexture* m_renderTexture = nullptr;
+        size_t m_surfaceBytes = 0;
+        bool m_dirty = true;
+        bool m_cachingEnabled = true;
+        unsigned m_contextEpoch = 0;
+    };
+} // namespace rock
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include <cocos2d.h>
+
+namespace rock::debug {
+    /// @brief How rock components render while debugging fill-rate
+    enum class HeatmapMode {
+        /// @brief Regular rendering
+        Off,
+        /// @brief Additive heat colors visible on screen: red for overdraw, green for fragments
+        /// that took the per-corner radius path, blue for fragments that get discarded
+        Live,
+        /// @brief Exact per-fragment counts (one unit per fragment in each channel), used by captureOverdraw
+        Capture,
+    };
+
+    /// @brief Fragment counts of a single rock node type
+    struct FragmentStats {
+        /// @brief Amount of fragments that ran the rock fragment shader
+        size_t shaded = 0;
+        /// @brief Amount of shaded fragments that took the per-corner sdRoundRect path instead of sdRoundRectFast
+        size_t slowPath = 0;
+        /// @brief Amount of shaded fragments that were discarded, or fully transparent in the analytic mode
+        size_t discarded = 0;
+
+        /// @brief Get the share of shaded fragments that didn't contribute anything
+        /// @return Ratio between 0 and 1
+        double getDiscardRatio() const;
+
+        /// @brief Get the share of shaded fragments that took the per-corner path
+        /// @return Ratio between 0 and 1
+        double getSlowPathRatio() const;
+    };
+
+    /// @brief Summary of a captureOverdraw call
+    struct OverdrawReport {
+        FragmentStats rects;
+        FragmentStats sprites;
+        /// @brief Amount of pixels in the capture
+        size_t pixels = 0;
+        /// @brief Amount of pixels covered by at least one rock fragment
+        size_t coveredPixels = 0;
+        /// @brief Highest amount of rock fragments shaded for a single pixel
+        unsigned maxOverdraw = 0;
+        /// @brief Amount of pixels where any count (shaded, slow path or discarded) of one node type reached 255.
+        /// Counts are clamped at 255, so these pixels might've had more fragments than reported
+        size_t saturatedPixels = 0;
+
+        /// @brief Get the average amount of rock fragments per covered pixel
+        /// @return Average overdraw
+        double getAverageOverdraw() const;
+    };
+
+    /// @brief Switch the fragment shaders of every rock component
+    /// @param mode New heatmap mode
+    void setHeatmapMode(HeatmapMode mode);
+
+    /// @brief Get the current heatmap mode
+    /// @return Current mode
+    HeatmapMode getHeatmapMode();
+
+    /// @brief Render rock components of a node tree offscreen and count their fragments.
+    /// Only rock components are drawn, one pass per node type, and counts are read back to the CPU.
+    /// Works with any GL implementation, including software ones on headless machines.
+    /// @note Counts are in pixels of the director (window size times content scale factor).
+    /// Clipping nodes and render textures inside of the tree are ignored
+    /// @param root Root of the tree, drawn with its world transform
+    /// @return Fragment counts of the tree
+    OverdrawReport captureOverdraw(cocos2d::CCNode* root);
+} // namespace rock::debug
\ No newline at end of file
@@ -0,0 +1,233 @@
+#pragma once
+#include <cocos2d.h>
+#include <rock/NodePool.hpp>
+
+#include <optional>
+#include <unordered_map>
+
+namespace rock {
+    /// @brief Axis along which a Layout places its children
+    enum class LayoutDirection {
+        /// @brief Left to right
+        Row,
+        /// @brief Top to bottom
+        Column,
+    };
+
+    /// @brief Distribution of leftover space along the main axis
+    enum class LayoutJustify {
+        Start,
+        Center,
+        End,
+        SpaceBetween,
+    };
+
+    /// @brief Placement of children along the cross axis of their line
+    enum class LayoutAlign {
+        Start,
+        Center,
+        End,
+        /// @brief Resize children to fill the line
+        Stretch,
+    };
+
+    /// @brief Struct representing inner spacing of a Layout
+    struct Padding {
+        float top;
+        float right;
+        float bottom;
+        float left;
+
+        /// @brief Construct Padding with individual sides (clockwise from top)
+        /// @param t Top padding
+        /// @param r Right padding
+        /// @param b Bottom padding
+        /// @param l Left padding
+        constexpr Padding(float t = 0.f, float r = 0.f, float b = 0.f, float l = 0.f)
+            : top(t), right(r), bottom(b), left(l) {}
+
+        /// @brief Construct Padding with the same value on every side
+        /// @param padding Padding for all sides
+        static constexpr Padding uniform(float padding) {
+            return Padding(padding, padding, padding, padding);
+        }
+    };
+
+    /// @brief Per-child options of a Layout
+    struct LayoutParams {
+        /// @brief Share of the free space the child takes when the line has room left
+        float grow = 0.f;
+        /// @brief How much the child shrinks (relative to its size) when the line overflows
+        float shrink = 1.f;
+        /// @brief Size of the child along the main axis, or a negative value to use its content size
+        float basis = -1.f;
+        /// @brief Cross axis alignment of the child, overriding the one of the Layout
+        std::optional<LayoutAlign> align;
+        /// @brief Whether the layout sets the content size of the child. By default only rock nodes
+        /// (RoundedRect, Layout, CachedNode and VirtualList) are resized
+        std::optional<bool> resize;
+    };
+
+    /// @brief A container that arranges its children in rows or columns, similar to CSS flexbox.
+    /// Layout is recalculated lazily before the next visit, and only for containers that have changed:
+    /// nested layouts with a fixed size are updated on their own without touching their parents.
+    /// @note Rock components notify their parent Layout when their size or visibility changes.
+    /// Changes to other nodes require a manual call to markDirty().
+    /// Only children that opt in through LayoutParams::resize (rock nodes by default) are resized. Others, like
+    /// sprites, labels and menus, keep their size: grow, shrink and stretch only change the space they take up,
+    /// and they're placed inside of it by their anchor point
+    class Layout : public cocos2d::CCNode {
+    public:
+        ROCK_POOLED_NODE(Layout)
+
+        Layout();
+        ~Layout() override;
+
+        /// @brief Create a Layout that sizes itself to fit its children
+        /// @param direction Main axis of the layout
+        static Layout* create(LayoutDirection direction = LayoutDirection::Row);
+
+        /// @brief Create a Layout with a fixed size
+        /// @param direction Main axis of the layout
+        /// @param size Size of the layout
+        static Layout* create(LayoutDirection direction, cocos2d::CCSize const& size);
+
+        /// @brief Set the main axis of the layout
+        /// @param direction New direction
+        void setDirection(LayoutDirection direction);
+
+        /// @brief Get the main axis of the layout
+        /// @return Current direction
+        LayoutDirection getDirection() const;
+
+        /// @brief Enable or disable wrapping children that don't fit into new lines.
+        /// Has no effect on auto-sized layouts
+        /// @param wrap Whether children should wrap
+        void setWrap(bool wrap);
+
+        /// @brief Check whether children wrap into new lines
+        /// @return True if wrapping is enabled
+        bool isWrap() const;
+
+        /// @brief Set the spacing between children and between lines
+        /// @param gap Spacing in points
+        void setGap(float gap);
+
+        /// @brief Set the spacing between children and between lines separately
+        /// @param gap Spacing between children of a line
+        /// @param lineGap Spacing between lines
+        void setGap(float gap, float lineGap);
+
+        /// @brief Get the spacing between children
+        /// @return Spacing in points
+        float getGap() const;
+
+        /// @brief Get the spacing between lines
+        /// @return Spacing in points
+        float getLineGap() const;
+
+        /// @brief Set the inner spacing of the layout
+        /// @param padding New padding
+        void setPadding(Padding const& padding);
+
+        /// @brief Get the inner spacing of the layout
+        /// @return Current padding
+        Padding const& getPadding() const;
+
+        /// @brief Set the distribution of leftover space along the main axis
+        /// @param justify New justification
+        void setJustify(LayoutJustify justify);
+
+        /// @brief Get the distribution of leftover space along the main axis
+        /// @return Current justification
+        LayoutJustify getJustify() const;
+
+        /// @brief Set the default cross axis alignment of children
+        /// @param align New alignment
+        void setAlign(LayoutAlign align);
+
+        /// @brief Get the default cross axis alignment of children
+        /// @return Current alignment
+        LayoutAlign getAlign() const;
+
+        /// @brief Enable or disable sizing the layout to fit its children.
+        /// Auto-sized layouts propagate changes of their children to their parent Layout
+        /// @param autoSize Whether the layout should fit its children
+        void setAutoSize(bool autoSize);
+
+        /// @brief Check whether the layout sizes itself to fit its children
+        /// @return True if the layout is auto-sized
+        bool isAutoSize() const;
+
+        /// @brief Set layout options of a child
+        /// @param child Child of this layout
+        /// @param params New options
+        void setLayoutParams(cocos2d::CCNode* child, LayoutParams const& params);
+
+        /// @brief Get layout options of a child
+        /// @param child Child of this layout
+        /// @return Options of the child, or the defaults if none were set
+        LayoutParams getLayoutParams(cocos2d::CCNode* child) const;
+
+        /// @brief Add a child with layout options
+        /// @param child Node to add
+        /// @param params Options of the child
+        void addChild(cocos2d::CCNode* child, LayoutParams const& params);
+
+        /// @brief Mark the layout as outdated, so it gets recalculated before the next visit
+        void markDirty();
+
+        /// @brief Check whether the layout will be recalculated before the next visit
+        /// @return True if the layout is outdated
+        bool isDirty() const;
+
+        /// @brief Recalculate the layout right away if it's outdated,
+        /// e.g. to read positions of children before the next visit
+        void relayout();
+
+        /// @brief Mark the parent Layout of the given node as outdated
+        /// @param node Node whose size or visibility has changed
+        static void invalidateParent(cocos2d::CCNode* node);
+
+    protected:
+        /// @brief Options of a child, and the size it had before the layout resized it
+        struct ChildInfo {
+            LayoutParams params;
+            cocos2d::CCSize natural;
+            cocos2d::CCSize assigned;
+            bool resized = false;
+        };
+
+        bool init(LayoutDirection direction, cocos2d::CCSize const& size, bool autoSize);
+
+        cocos2d::CCSize measure();
+        cocos2d::CCSize getNaturalSize(cocos2d::CCNode* child);
+        cocos2d::CCSize getItemSize(cocos2d::CCNode* child);
+        void childChanged(cocos2d::CCNode* child);
+
+    public:
+        using CCNode::addChild;
+
+        void visit() override;
+        void setContentSize(cocos2d::CCSize const& contentSize) override;
+        void addChild(cocos2d::CCNode* child, int zOrder, int tag) override;
+        void removeChild(cocos2d::CCNode* child, bool cleanup) override;
+        void removeAllChildrenWithCleanup(bool cleanup) override;
+        void reorderChild(cocos2d::CCNode* child, int zOrder) override;
+
+    protected:
+        LayoutDirection m_direction = LayoutDirection::Row;
+        LayoutJustify m_justify = LayoutJustify::Start;
+        LayoutAlign m_align = LayoutAlign::Start;
+        Padding m_padding;
+        float m_gap = 0.f;
+        float m_lineGap = 0.f;
+        bool m_wrap = false;
+        bool m_autoSize = false;
+        bool m_dirty = true;
+        bool m_inLayout = false;
+        bool m_measureValid = false;
+        cocos2d::CCSize m_measuredSize;
+        std::unordered_map<cocos2d::CCNode*, ChildInfo> m_childInfo;
+    };
+} // namespace rock
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+namespace rock {
+    /// @brief Occupancy statistics of a NodePool
+    struct NodePoolStats {
+        /// @brief Amount of slabs allocated from the system allocator
+        size_t slabs = 0;
+        /// @brief Total amount of blocks in all slabs
+        size_t capacity = 0;
+        /// @brief Amount of blocks currently holding a node
+        size_t used = 0;
+        /// @brief Highest amount of blocks that were used at once
+        size_t peak = 0;
+    };
+
+    /// @brief Slab allocator with a per-type free list, used for class-level operator new/delete
+    /// of rock nodes. Allocations of a different size (e.g. derived classes) go to the global allocator.
+    /// @note Not thread-safe, nodes must be created and destroyed on the main thread.
+    /// Slabs are never returned to the system, they're reused by later allocations instead.
+    /// @tparam T Node type
+    /// @tparam SlabSize Amount of nodes per slab
+    template <typename T, size_t SlabSize = 64>
+    class NodePool {
+    public:
+        /// @brief Allocate memory for a node
+        /// @param size Size of the allocation
+        /// @return Pointer to uninitialized memory
+        static void* allocate(size_t size) {
+            if (size != sizeof(T)) {
+                return ::operator new(size);
+            }
+
+            if (!s_freeList) {
+                allocateSlab();
+            }
+
+            auto block = s_freeList;
+            s_freeList = block->next;
+
+            s_stats.used++;
+            if (s_stats.used > s_stats.peak) {
+                s_stats.peak = s_stats.used;
+            }
+
+            return block;
+        }
+
+        /// @brief Return memory of a node back to the pool
+        /// @param ptr Pointer returned by allocate
+        /// @param size Size of the allocation
+        static void deallocate(void* ptr, size_t size) {
+            if (!ptr) return;
+
+            if (size != sizeof(T)) {
+                return ::operator delete(ptr);
+            }
+
+            auto block = static_cast<Block*>(ptr);
+            block->next = s_freeList;
+            s_freeList = block;
+            s_stats.used--;
+        }
+
+        /// @brief Get occupancy statistics of the pool
+        /// @return Pool statistics
+        static NodePoolStats const& getStats() {
+            return s_stats;
+        }
+
+    private:
+        union Block {
+            Block* next;
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        static_assert(alignof(Block) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+        static void allocateSlab() {
+            auto slab = static_cast<Block*>(::operator new(sizeof(Block) * SlabSize));
+            for (size_t i = 0; i < SlabSize; ++i) {
+                slab[i].next = i + 1 < SlabSize ? &slab[i + 1] : s_freeList;
+            }
+            s_freeList = slab;
+
+            s_stats.slabs++;
+            s_stats.capacity += SlabSize;
+        }
+
+        static inline Block* s_freeList = nullptr;
+        static inline NodePoolStats s_stats;
+    };
+} // namespace rock
+
+/// @brief Route operator new/delete of a rock node through its NodePool,
+/// when the library is built with ROCK_NODE_POOL enabled
+#ifdef ROCK_NODE_POOL
+#define ROCK_POOLED_NODE(Class) \
+    static void* operator new(size_t size) { return ::rock::NodePool<Class>::allocate(size); } \
+    static void operator delete(void* ptr, size_t size) { ::rock::NodePool<Class>::deallocate(ptr, size); }
+#else
+#define ROCK_POOLED_NODE(Class)
+#endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+#include <cocos2d.h>
+
+namespace rock {
+    /// @brief Vertex format used by batched rock draws
+    struct BatchVertex {
+        cocos2d::ccVertex3F position;
+        cocos2d::ccColor4B color;
+        cocos2d::ccTex2F texCoords;
+        cocos2d::ccTex2F localUV;
+        std::array<float, 4> radii;
+        cocos2d::ccVertex2F size;
+        float pixelScale;
+    };
+
+    /// @brief Node-space quad submitted to the queue. Expanded into transformed vertices when the queue is flushed
+    struct BatchQuad {
+        /// @brief Corner positions, in triangle strip order
+        std::array<cocos2d::ccVertex2F, 4> positions;
+        std::array<cocos2d::ccColor4B, 4> colors;
+        std::array<cocos2d::ccTex2F, 4> texCoords;
+        std::array<float, 4> radii;
+        cocos2d::ccVertex2F size;
+    };
+
+    /// @brief Opt-in queue that collects draws from rock components and merges
+    /// consecutive compatible ones (same program, blend function and texture) into a single draw call.
+    /// @note The queue is flushed automatically before any other node uses a shader program,
+    /// before render textures change the render target, before a scissor rect is set, and at the end
+    /// of a frame. Children of clipping nodes and scroll layers are drawn immediately. Code that changes
+    /// GL state directly (e.g. enabling or disabling GL_SCISSOR_TEST) should call flush() first.
+    class RenderQueue {
+    public:
+        /// @brief Get the shared render queue
+        static RenderQueue* get();
+
+        /// @brief Enable or disable batching. When disabled, rock components draw immediately
+        /// @param enabled Whether batching should be used
+        void setEnabled(bool enabled);
+
+        /// @brief Check whether batching is enabled
+        /// @return True if rock components submit their draws to the queue
+        bool isEnabled() const;
+
+        /// @brief Add a quad to the queue. The current modelview matrix is recorded with it, and vertices
+        /// are generated from both when the queue is flushed
+        /// @param program Shader program to draw the quad with
+        /// @param blendFunc Blend function to draw the quad with
+        /// @param texture Texture name to bind, or 0 for none
+        /// @param quad Quad in node space
+        void submit(
+            cocos2d::CCGLProgram* program,
+            cocos2d::ccBlendFunc blendFunc,
+            GLuint texture,
+            BatchQuad const& quad
+        );
+
+        /// @brief Set the maximum amount of threads that generate vertices of large batches, including the main thread
+        /// @param threads Amount of threads. 1 generates everything on the main thread, 0 uses every worker of the shared ThreadPool
+        void setMaxThreads(size_t threads);
+
+        /// @brief Get the maximum amount of threads that generate vertices of large batches
+        /// @return Amount of threads, 0 if every worker is used
+        size_t getMaxThreads() const;
+
+        /// @brief Draw everything that was queued so far
+        void flush();
+
+        /// @brief Get the amount of draw calls issued by the queue since the last reset
+        /// @return Amount of draw calls
+        size_t getDrawCalls() const;
+
+        /// @brief Get the amount of quads drawn by the queue since the last reset
+        /// @return Amount of quads
+        size_t getQuads() const;
+
+        /// @brief Reset draw call and quad counters
+        void resetStats();
+
+    private:
+        RenderQueue();
+
+        bool isCompatible(
+            cocos2d::CCGLProgram* program,
+            cocos2d::ccBlendFunc blendFunc,
+            GLuint texture
+        ) const;
+
+        void generateVertices(size_t count);
+        void uploadBuffers();
+
+        struct QueuedQuad {
+            BatchQuad quad;
+            kmMat4 transform;
+        };
+
+        std::vector<QueuedQuad> m_queued;
+        std::vector<BatchVertex> m_vertices;
+        std::vector<GLushort> m_indices;
+        GLuint m_vertexBuffer = 0;
+        GLuint m_indexBuffer = 0;
+        unsigned m_bufferEpoch = 0;
+        size_t m_maxThreads = 0;
+        cocos2d::CCGLProgram* m_program = nullptr;
+        cocos2d::ccBlendFunc m_blendFunc{};
+        GLuint m_texture = 0;
+        size_t m_drawCalls = 0;
+        size_t m_quads = 0;
+        bool m_enabled = false;
+        bool m_flushing = false;
+    };
+} // namespace rock
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 #include <cocos2d.h>
+#include <rock/NodePool.hpp>
+#include <rock/RenderQueue.hpp>
 
 namespace rock {
     /// @brief Struct representing corner radii for a rounded rectangle
@@ -24,9 +26,32 @@ namespace rock {
         }
     };
 
+    /// @brief How rounded edges are anti-aliased
+    enum class AntiAliasMode {
+        /// @brief Use the global mode (see setDefaultAntiAliasMode)
+        Inherit,
+        /// @brief Edge width from screen-space derivatives (fwidth), with discarded transparent pixels.
+        /// Requires GL_OES_standard_derivatives on mobile
+        Derivative,
+        /// @brief Edge width from a pixel scale computed on the CPU. No derivatives and no discard,
+        /// which keeps early depth and tile optimizations working on low-end GPUs.
+        /// Assumes the node isn't drawn with perspective
+        Analytic,
+    };
+
+    /// @brief Set the anti-aliasing mode of rock nodes that don't override it
+    /// @param mode New mode. Inherit falls back to Derivative
+    void setDefaultAntiAliasMode(AntiAliasMode mode);
+
+    /// @brief Get the anti-aliasing mode of rock nodes that don't override it
+    /// @return Current global mode
+    AntiAliasMode getDefaultAntiAliasMode();
+
     /// @brief A node similar to CCLayerColor, but with rounded corners
     class RoundedRect : public cocos2d::CCNodeRGBA, public cocos2d::CCBlendProtocol {
     public:
+        ROCK_POOLED_NODE(RoundedRect)
+
         ~RoundedRect() override;
 
         /// @brief Create a RoundedRect with specified color, corner radius, and size
@@ -77,6 +102,14 @@ namespace rock {
         /// @return Current corner radii
         Radii const& getRadii() const;
 
+        /// @brief Set the anti-aliasing mode of this node
+        /// @param mode New mode, or Inherit to use the global one
+        void setAntiAliasMode(AntiAliasMode mode);
+
+        /// @brief Get the anti-aliasing mode of this node
+        /// @return Current mode, Inherit if the global one is used
+        AntiAliasMode getAntiAliasMode() const;
+
     protected:
         bool init(
             cocos2d::ccColor4B color,
@@ -84,9 +117,11 @@ namespace rock {
             cocos2d::CCSize const& size
         );
 
+        bool reloadShader();
         void draw() override;
         void updateColor();
         void updateVertices();
+        BatchQuad makeBatchQuad() const;
 
     public:
         cocos2d::ccBlendFunc getBlendFunc() override;
@@ -96,6 +131,17 @@ namespace rock {
         void setOpacity(GLubyte opacity) override;
         void setContentSize(cocos2d::CCSize const& contentSize) override;
 
+        using CCNodeRGBA::setPosition;
+        using CCNodeRGBA::setScale;
+
+        void setPosition(cocos2d::CCPoint const& position) override;
+        void setRotation(float rotation) override;
+        void setScale(float scale) override;
+        void setScaleX(float scaleX) override;
+        void setScaleY(float scaleY) override;
+        void setAnchorPoint(cocos2d::CCPoint const& anchorPoint) override;
+        void setVisible(bool visible) override;
+
     protected:
         std::array<cocos2d::ccVertex2F, 4> m_squareVertices{};
         std::array<cocos2d::ccColor4F, 4> m_squareColors{};
@@ -103,11 +149,18 @@ namespace rock {
         cocos2d::ccBlendFunc m_blendFunc = {GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA};
         GLint m_radiiLoc = -1;
         GLint m_sizeLoc = -1;
+        GLint m_pixelScaleLoc = -1;
+        unsigned m_contextEpoch = 0;
+        AntiAliasMode m_antiAliasMode = AntiAliasMode::Inherit;
+        // no immediate program is loaded until the first draw outside of the RenderQueue
+        size_t m_shaderVariant = static_cast<size_t>(-1);
     };
 
     /// @brief A sprite with rounded corners
     class RoundedSprite : public cocos2d::CCSprite {
     public:
+        ROCK_POOLED_NODE(RoundedSprite)
+
         ~RoundedSprite() override;
 
         /// @brief Create a RoundedSprite with specified image file and corner radii
@@ -174,12 +227,42 @@ namespace rock {
             float radius
         );
 
+        /// @brief Create a RoundedSprite that decodes its image file on a background thread.
+        /// Until the texture is ready, a rounded placeholder of the specified size is drawn instead
+        /// @param filename Image file path
+        /// @param radii Corner radii for each corner
+        /// @param placeholderSize Size of the sprite while the image is loading
+        static RoundedSprite* createAsync(
+            char const* filename,
+            Radii const& radii,
+            cocos2d::CCSize const& placeholderSize
+        );
+
+        /// @brief Create a RoundedSprite that decodes its image file on a background thread.
+        /// Until the texture is ready, a rounded placeholder of the specified size is drawn instead
+        /// @param filename Image file path
+        /// @param radius Corner radius for all corners
+        /// @param placeholderSize Size of the sprite while the image is loading
+        static RoundedSprite* createAsync(
+            char const* filename,
+            float radius,
+            cocos2d::CCSize const& placeholderSize
+        );
+
     protected:
         bool initWithTexture(
             cocos2d::CCTexture2D* texture,
             Radii const& radii
         );
 
+        bool initAsync(
+            char const* filename,
+            Radii const& radii,
+            cocos2d::CCSize const& placeholderSize
+        );
+
+        void onImageLoaded(cocos2d::CCImage* image, std::string const& path);
+
         bool initWithFile(
             char const* filename,
             Radii const& radii
@@ -196,7 +279,9 @@ namespace rock {
         );
 
         bool init(Radii const& radii);
+        bool reloadShader();
         void draw() override;
+        BatchQuad makeBatchQuad() const;
 
     public:
         /// @brief Set the corner radii
@@ -211,9 +296,61 @@ namespace rock {
         /// @return Current corner radii
         Radii const& getRadii() const;
 
+        /// @brief Set the anti-aliasing mode of this node
+        /// @param mode New mode, or Inherit to use the global one
+        void setAntiAliasMode(AntiAliasMode mode);
+
+        /// @brief Get the anti-aliasing mode of this node
+        /// @return Current mode, Inherit if the global one is used
+        AntiAliasMode getAntiAliasMode() const;
+
+        /// @brief Check whether the texture is ready. Only false for sprites created with createAsync
+        /// @return True if the texture is loaded
+        bool isLoaded() const;
+
+        /// @brief Set the color of the placeholder drawn while the texture is loading
+        /// @param color New placeholder color
+        void setPlaceholderColor(cocos2d::ccColor4B const& color);
+
+        /// @brief Get the color of the placeholder drawn while the texture is loading
+        /// @return Current placeholder color
+        cocos2d::ccColor4B const& getPlaceholderColor() const;
+
+        /// @brief Set a callback called on the main thread once the texture is loaded.
+        /// The sprite takes the size of the texture right before the callback is called.
+        /// The callback is also called if loading fails, with isLoaded() still returning false
+        /// and the placeholder still shown. If the sprite is already loaded (e.g. the texture was cached)
+        /// or has already failed, the callback is called on the next frame
+        /// @param callback Callback to call
+        void setLoadCallback(std::function<void(RoundedSprite*)> callback);
+
+        void setColor(cocos2d::ccColor3B const& color) override;
+        void setOpacity(GLubyte opacity) override;
+        void setContentSize(cocos2d::CCSize const& contentSize) override;
+
+        using CCSprite::setPosition;
+        using CCSprite::setScale;
+
+        void setPosition(cocos2d::CCPoint const& position) override;
+        void setRotation(float rotation) override;
+        void setScale(float scale) override;
+        void setScaleX(float scaleX) override;
+        void setScaleY(float scaleY) override;
+        void setAnchorPoint(cocos2d::CCPoint const& anchorPoint) override;
+        void setVisible(bool visible) override;
+
     protected:
         Radii m_radii;
         GLint m_radiiLoc = -1;
         GLint m_sizeLoc = -1;
+        GLint m_pixelScaleLoc = -1;
+        unsigned m_contextEpoch = 0;
+        AntiAliasMode m_antiAliasMode = AntiAliasMode::Inherit;
+        // no immediate program is loaded until the first draw outside of the RenderQueue
+        size_t m_shaderVariant = static_cast<size_t>(-1);
+        RoundedRect* m_placeholder = nullptr;
+        cocos2d::ccColor4B m_placeholderColor = {128, 128, 128, 128};
+        std::function<void(RoundedSprite*)> m_loadCallback;
+        bool m_loadFailed = false;
     };
 } // namespace rock
\ No newline at end of file
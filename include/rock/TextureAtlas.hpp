@@ -0,0 +1,120 @@
+#pragma once
+#include <cocos2d.h>
+
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+namespace rock {
+    /// @brief Packs images into shared textures at runtime, so rounded sprites loaded from
+    /// different files bind the same texture and can be merged into a single draw by the RenderQueue.
+    /// Images are placed with a guillotine packer, and space of removed images is reused.
+    /// @note Pages hold premultiplied alpha like textures loaded through CCTextureCache, straight sources are converted
+    class TextureAtlas : public cocos2d::CCObject {
+    public:
+        /// @brief Rectangle inside of an atlas page, in pixels from the top-left corner
+        struct Region {
+            unsigned x;
+            unsigned y;
+            unsigned width;
+            unsigned height;
+        };
+
+        ~TextureAtlas() override;
+
+        /// @brief Create an empty atlas. Pages are only allocated once images are added
+        /// @param pageSize Width and height of every page in pixels
+        /// @param padding Pixels around every image, filled with its edge pixels, so texture filtering
+        /// along the anti-aliased rounded edge doesn't pick up neighboring images
+        static TextureAtlas* create(unsigned pageSize = 1024, unsigned padding = 2);
+
+        /// @brief Add an image to the atlas. Returns the existing frame if the key is already in use
+        /// @param key Key to look the frame up with later
+        /// @param image Decoded image with 8 bits per component
+        /// @return Frame of the image in the atlas (owned by the atlas), or nullptr if it doesn't fit
+        cocos2d::CCSpriteFrame* addImage(std::string const& key, cocos2d::CCImage* image);
+
+        /// @brief Load an image file and add it to the atlas, using the file name as the key
+        /// @param filename Image file path
+        /// @return Frame of the image in the atlas (owned by the atlas), or nullptr on failure
+        cocos2d::CCSpriteFrame* addFile(char const* filename);
+
+        /// @brief Decode an image file on a background thread and add it to the atlas on the main thread,
+        /// using the file name as the key
+        /// @param filename Image file path
+        /// @param callback Called on the main thread with the frame, or nullptr on failure
+        void addFileAsync(char const* filename, std::function<void(cocos2d::CCSpriteFrame*)> callback);
+
+        /// @brief Get the frame of an image in the atlas
+        /// @param key Key the image was added with
+        /// @return Frame of the image, or nullptr if there's no such image
+        cocos2d::CCSpriteFrame* getFrame(std::string_view key) const;
+
+        /// @brief Remove an image, so its space can be reused. Pages without images are freed
+        /// @note Sprites still using the frame keep drawing whatever ends up in its place
+        /// @param key Key the image was added with
+        /// @return True if the image was in the atlas
+        bool remove(std::string_view key);
+
+        /// @brief Remove every image and free all pages
+        void clear();
+
+        /// @brief Set the maximum amount of pages. Images that don't fit into any page are rejected
+        /// @param pages Maximum amount of pages
+        void setMaxPages(size_t pages);
+
+        /// @brief Get the maximum amount of pages
+        /// @return Maximum amount of pages
+        size_t getMaxPages() const;
+
+        /// @brief Get the amount of allocated pages
+        /// @return Amount of pages
+        size_t getPageCount() const;
+
+        /// @brief Get the amount of images in the atlas
+        /// @return Amount of images
+        size_t getImageCount() const;
+
+        /// @brief Get the share of page area taken by images and their padding
+        /// @return Ratio between 0 and 1
+        float getOccupancy() const;
+
+    protected:
+        struct Page {
+            cocos2d::CCTexture2D* texture = nullptr;
+            std::vector<Region> freeRegions;
+            size_t imageCount = 0;
+            size_t usedArea = 0;
+            // copy of the page contents, only kept on android to upload it again after the context is recreated
+            std::vector<uint8_t> pixels;
+        };
+
+        struct Entry {
+            Page* page = nullptr;
+            Region region{};
+            cocos2d::CCSpriteFrame* frame = nullptr;
+        };
+
+        struct KeyHash {
+            using is_transparent = void;
+            size_t operator()(std::string_view key) const {
+                return std::hash<std::string_view>{}(key);
+            }
+        };
+
+        bool init(unsigned pageSize, unsigned padding);
+
+        Page* addPage();
+        void removePage(Page* page);
+        void uploadRegion(Page& page, Region const& region, std::vector<uint8_t> const& pixels);
+        void onContextRecreated(cocos2d::CCObject*);
+
+        std::vector<std::unique_ptr<Page>> m_pages;
+        std::unordered_map<std::string, Entry, KeyHash, std::equal_to<>> m_entries;
+        unsigned m_pageSize = 1024;
+        unsigned m_padding = 2;
+        size_t m_maxPages = 4;
+        unsigned m_contextEpoch = 0;
+    };
+} // namespace rock
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rock {
+    /// @brief A small pool of worker threads for background work (e.g. image decoding)
+    /// @note Tasks must not touch cocos2d objects, since cocos2d is not thread-safe.
+    /// Use geode::queueInMainThread to hand results back to the main thread.
+    class ThreadPool {
+    public:
+        /// @brief Create a pool with specified amount of worker threads
+        /// @param threads Amount of worker threads (at least 1)
+        explicit ThreadPool(size_t threads);
+        ~ThreadPool();
+
+        ThreadPool(ThreadPool const&) = delete;
+        ThreadPool& operator=(ThreadPool const&) = delete;
+
+        /// @brief Get the shared pool, which uses all but one hardware thread
+        static ThreadPool* get();
+
+        /// @brief Queue a task to be run on one of the worker threads
+        /// @param task Task to run
+        void submit(std::function<void()> task);
+
+        /// @brief Split a range of indices into chunks and process them on the worker threads and
+        /// the calling thread. Every thread starts with its own share of chunks, and threads that run
+        /// out steal half of the remaining chunks of another one. Blocks until every chunk is done
+        /// @param count Amount of indices
+        /// @param grainSize Amount of indices per chunk
+        /// @param func Function called with [begin, end) ranges of indices
+        /// @param maxThreads Maximum amount of threads working on the range, including the calling thread.
+        /// 0 uses all worker threads
+        void parallelFor(
+            size_t count,
+            size_t grainSize,
+            std::function<void(size_t begin, size_t end)> const& func,
+            size_t maxThreads = 0
+        );
+
+        /// @brief Get the amount of worker threads
+        /// @return Amount of worker threads
+        size_t getThreadCount() const;
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> m_threads;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stopping = false;
+    };
+} // namespace rock
\ No newline at end of file
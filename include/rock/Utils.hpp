@@ -2,9 +2,71 @@
 #include <cocos2d.h>
 
 namespace rock::util {
+    /// @brief Vertex attribute locations used by rock shaders, in addition to the cocos2d ones
+    constexpr GLuint VERTEX_ATTRIB_LOCAL_UV = 3;
+    constexpr GLuint VERTEX_ATTRIB_RADII = 4;
+    constexpr GLuint VERTEX_ATTRIB_SIZE = 5;
+    constexpr GLuint VERTEX_ATTRIB_PIXEL_SCALE = 6;
+
+    /// @brief Get the current GL context generation, which increases every time the context is lost
+    /// @return Current context generation
+    unsigned getContextEpoch();
+
+    /// @brief Start increasing the context generation when android recreates the GL context.
+    /// Observers registered afterwards see the new generation in the same notification
+    /// @note Called automatically by getShaderProgram, safe to call more than once
+    void watchContextLoss();
+
+    /// @brief Mark every rock shader program as lost. Programs are recompiled lazily,
+    /// the next time they're requested with getShaderProgram.
+    /// @note Called automatically when android recreates the GL context
+    void notifyContextLost();
+
+    /// @brief Get the size of the current viewport in pixels. The size is cached until cocos
+    /// changes the viewport (or a render texture is bound), so draws don't each stall on a GL query
+    /// @return Viewport size in pixels
+    cocos2d::CCSize getViewportSize();
+
+    /// @brief Drop the cached viewport size, so the next getViewportSize() reads it from GL again
+    /// @note Called automatically at the start of every frame, around render textures and
+    /// whenever cocos sets the viewport. Call it after changing the viewport with glViewport directly
+    void invalidateViewport();
+
+    /// @brief Get the amount of framebuffer pixels per unit of the node currently being drawn,
+    /// from the current modelview and projection matrices and the viewport of the render target
+    /// @return Pixels per node unit
+    float getPixelScale();
+
+    /// @brief Get the amount of framebuffer pixels per unit of a node. Doesn't touch any GL or cocos state,
+    /// so it can be called from any thread
+    /// @param modelview Modelview matrix of the node
+    /// @param projection Projection matrix of the render target
+    /// @param viewportWidth Width of the viewport in pixels
+    /// @param viewportHeight Height of the viewport in pixels
+    /// @return Pixels per node unit
+    float getPixelScale(
+        kmMat4 const& modelview,
+        kmMat4 const& projection,
+        float viewportWidth,
+        float viewportHeight
+    );
+
+    /// @brief Guess the format of an image file from its extension
+    /// @param path Path to the image file
+    /// @return Image format, kFmtUnKnown if the extension isn't recognized
+    cocos2d::CCImage::EImageFormat getImageFormat(std::string const& path);
+
+    /// @brief Get a cached shader program, or compile and cache it if it doesn't exist yet.
+    /// Sources are kept, so the program can be recompiled after the GL context is lost.
+    /// Programs another mod put into CCShaderCache first are shared, and only that mod recompiles them
+    /// @param name Key of the program in CCShaderCache
+    /// @param vertShader Vertex shader source
+    /// @param fragShader Fragment shader source
+    /// @param defines Preprocessor definitions prepended to both shaders (e.g. "#define FOO\n")
     cocos2d::CCGLProgram* getShaderProgram(
         char const* name,
         char const* vertShader,
-        char const* fragShader
+        char const* fragShader,
+        char const* defines = ""
     );
 } // namespace rock::util
\ No newline at end of file
@@ -0,0 +1,137 @@
+#pragma once
+#include <cocos2d.h>
+#include <deque>
+#include <functional>
+
+namespace rock {
+    /// @brief A vertically scrolling list, that only keeps nodes for visible rows.
+    /// Rows that scroll out of view are recycled and rebound to new indices,
+    /// so the amount of nodes doesn't depend on the amount of rows.
+    class VirtualList : public cocos2d::CCLayer {
+    public:
+        /// @brief Creates a new row node. Called only when the pool of recycled rows is empty
+        using RowFactory = std::function<cocos2d::CCNode*()>;
+
+        /// @brief Updates a (possibly recycled) row node to display the row at the given index
+        using RowBinder = std::function<void(cocos2d::CCNode* row, size_t index)>;
+
+        /// @brief Returns the height of the row at the given index
+        using RowHeight = std::function<float(size_t index)>;
+
+        ~VirtualList() override;
+
+        /// @brief Create a VirtualList with specified viewport size and row callbacks
+        /// @param size Size of the visible area
+        /// @param factory Callback creating new row nodes
+        /// @param binder Callback binding row nodes to row indices
+        static VirtualList* create(
+            cocos2d::CCSize const& size,
+            RowFactory factory,
+            RowBinder binder
+        );
+
+        /// @brief Set the amount of rows and reload the list
+        /// @param count New amount of rows
+        void setRowCount(size_t count);
+
+        /// @brief Get the amount of rows
+        /// @return Amount of rows
+        size_t getRowCount() const;
+
+        /// @brief Use the same height for all rows
+        /// @param height Height of a single row, at least 1 point
+        void setRowHeight(float height);
+
+        /// @brief Use a callback to query the height of each row.
+        /// Heights are queried lazily, only up to the furthest row that was scrolled to
+        /// @param callback Callback returning row heights. Negative heights are treated as 0
+        /// @param estimatedHeight Height used for rows that weren't measured yet, at least 1 point
+        void setRowHeight(RowHeight callback, float estimatedHeight);
+
+        /// @brief Set the extra area above and below the viewport where rows are kept alive
+        /// @param margin Margin in points
+        void setOverscan(float margin);
+
+        /// @brief Rebind all visible rows and remeasure row heights
+        void reloadData();
+
+        /// @brief Remeasure and rebind a single row, after its data has changed
+        /// @param index Index of the changed row
+        void invalidateRow(size_t index);
+
+        /// @brief Set the scroll offset, measured from the top of the list
+        /// @param offset New scroll offset, clamped to the valid range
+        void setScrollOffset(float offset);
+
+        /// @brief Get the scroll offset, measured from the top of the list
+        /// @return Current scroll offset
+        float getScrollOffset() const;
+
+        /// @brief Get the largest valid scroll offset. Uses estimated heights for rows that weren't measured yet
+        /// @return Maximum scroll offset
+        float getMaxScrollOffset() const;
+
+        /// @brief Scroll so that the row at the given index is at the top of the viewport
+        /// @param index Row index
+        void scrollToRow(size_t index);
+
+        /// @brief Get the amount of rows that currently have a node bound to them
+        /// @return Amount of active rows
+        size_t getActiveRowCount() const;
+
+        /// @brief Get the amount of recycled row nodes waiting to be reused
+        /// @return Amount of pooled rows
+        size_t getPooledRowCount() const;
+
+    protected:
+        bool init(
+            cocos2d::CCSize const& size,
+            RowFactory factory,
+            RowBinder binder
+        );
+
+        float getRowTop(size_t index);
+        float measureRow(size_t index);
+        float getRowHeight(size_t index);
+        size_t getRowAt(float offset);
+        void measureUntil(float offset);
+        float getContentHeight() const;
+
+        cocos2d::CCNode* obtainRow(size_t index);
+        void recycleRow(cocos2d::CCNode* row);
+        void placeRow(cocos2d::CCNode* row, size_t index);
+        void updateVisibleRows();
+
+    public:
+        void visit() override;
+        void update(float dt) override;
+        void setContentSize(cocos2d::CCSize const& contentSize) override;
+
+        void registerWithTouchDispatcher() override;
+        bool ccTouchBegan(cocos2d::CCTouch* touch, cocos2d::CCEvent* event) override;
+        void ccTouchMoved(cocos2d::CCTouch* touch, cocos2d::CCEvent* event) override;
+        void ccTouchEnded(cocos2d::CCTouch* touch, cocos2d::CCEvent* event) override;
+        void ccTouchCancelled(cocos2d::CCTouch* touch, cocos2d::CCEvent* event) override;
+        void scrollWheel(float y, float x) override;
+
+    protected:
+        RowFactory m_factory;
+        RowBinder m_binder;
+        RowHeight m_rowHeightCallback;
+        float m_rowHeight = 30.f;
+
+        // m_rowTops[i] is the top of row i. measured lazily, only used with a height callback
+        std::vector<float> m_rowTops;
+
+        cocos2d::CCNode* m_content = nullptr;
+        std::deque<cocos2d::CCNode*> m_activeRows;
+        std::vector<cocos2d::CCNode*> m_pool;
+        size_t m_firstActive = 0;
+        size_t m_rowCount = 0;
+
+        float m_scrollOffset = 0.f;
+        float m_overscan = 50.f;
+        float m_velocity = 0.f;
+        bool m_touching = false;
+    };
+} // namespace rock
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <rock/Blueprint.hpp>
+#include <rock/RoundedRect.hpp>
+
+#include <Geode/loader/Log.hpp>
+
+#ifdef GEODE_IS_WINDOWS
+#include <Windows.h>
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rock {
+    static void* mapFile(std::string const& path, size_t& size) {
+    #ifdef GEODE_IS_WINDOWS
+        std::filesystem::path fsPath(std::u8string(reinterpret_cast<char8_t const*>(path.data()), path.size()));
+        auto file = CreateFileW(
+            fsPath.c_str(), GENERIC_READ, FILE_SHARE_READ,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+        );
+        if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return nullptr;
+        }
+
+        auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) return nullptr;
+
+        // the view keeps the mapping alive on its own
+        auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view) return nullptr;
+
+        size = static_cast<size_t>(fileSize.QuadPart);
+        return view;
+    #else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            close(fd);
+            return nullptr;
+        }
+
+        auto view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED) return nullptr;
+
+        size = static_cast<size_t>(info.st_size);
+        return view;
+    #endif
+    }
+
+    static void unmapFile(void* view, size_t size) {
+    #ifdef GEODE_IS_WINDOWS
+        UnmapViewOfFile(view);
+    #else
+        munmap(view, size);
+    #endif
+    }
+
+    Blueprint::~Blueprint() {
+        if (m_mapping) {
+            unmapFile(m_mapping, m_size);
+        }
+    }
+
+    std::unique_ptr<Blueprint> Blueprint::load(char const* filename) {
+        std::string path = cocos2d::CCFileUtils::sharedFileUtils()->fullPathForFilename(filename, false);
+        auto ret = std::unique_ptr<Blueprint>(new Blueprint());
+
+        if (auto view = mapFile(path, ret->m_size)) {
+            ret->m_mapping = view;
+            ret->m_data = static_cast<uint8_t const*>(view);
+        } else {
+            // files inside of the android apk can't be mapped, read them instead
+            unsigned long size = 0;
+            auto data = cocos2d::CCFileUtils::sharedFileUtils()->getFileData(path.c_str(), "rb", &size);
+            if (!data) {
+                geode::log::error("Failed to open blueprint {}", path);
+                return nullptr;
+            }
+
+            ret->m_buffer.assign(data, data + size);
+            delete[] data;
+            ret->m_data = ret->m_buffer.data();
+            ret->m_size = ret->m_buffer.size();
+        }
+
+        if (!ret->validate()) {
+            geode::log::error("Invalid blueprint {}", path);
+            return nullptr;
+        }
+
+        return ret;
+    }
+
+    std::unique_ptr<Blueprint> Blueprint::loadFromMemory(std::vector<uint8_t> data) {
+        auto ret = std::unique_ptr<Blueprint>(new Blueprint());
+        ret->m_buffer = std::move(data);
+        ret->m_data = ret->m_buffer.data();
+        ret->m_size = ret->m_buffer.size();
+
+        if (!ret->validate()) {
+            geode::log::error("Invalid blueprint data");
+            return nullptr;
+        }
+
+        return ret;
+    }
+
+    bool Blueprint::validate() {
+        using namespace blueprint;
+
+        if (m_size < sizeof(Header)) return false;
+
+        Header header;
+        std::memcpy(&header, m_data, sizeof(Header));
+        if (header.magic != MAGIC || header.version != VERSION) return false;
+        if (header.nodeCount == 0 || header.nodesOffset % alignof(NodeRecord) != 0) return false;
+
+        auto nodesEnd = uint64_t(header.nodesOffset) + uint64_t(header.nodeCount) * sizeof(NodeRecord);
+        auto stringsEnd = uint64_t(header.stringsOffset) + uint64_t(header.stringsSize);
+        if (nodesEnd > m_size || stringsEnd > m_size) return false;
+        if (header.stringsSize > 0 && m_data[stringsEnd - 1] != '\0') return false;
+
+        m_nodes = reinterpret_cast<NodeRecord const*>(m_data + header.nodesOffset);
+        m_nodeCount = header.nodeCount;
+        m_strings = reinterpret_cast<char const*>(m_data + header.stringsOffset);
+        m_stringsSize = header.stringsSize;
+
+        // pre-order tree has to have exactly one root, and every child slot has to be filled
+        uint64_t pending = 1;
+        for (auto const& record : this->getNodes()) {
+            if (pending == 0) return false;
+            if (record.type > NodeType::RoundedSprite) return false;
+            if (record.frameName != NO_STRING && record.frameName >= m_stringsSize) return false;
+            pending = pending - 1 + record.childCount;
+        }
+
+        return pending == 0;
+    }
+
+    std::span<blueprint::NodeRecord const> Blueprint::getNodes() const {
+        return {m_nodes, m_nodeCount};
+    }
+
+    char const* Blueprint::getString(uint32_t offset) const {
+        if (offset == blueprint::NO_STRING) return nullptr;
+        return m_strings + offset;
+    }
+
+    cocos2d::CCNode* Blueprint::createNode(blueprint::NodeRecord const& record) const {
+        using blueprint::NodeType;
+
+        cocos2d::CCNode* node = nullptr;
+        Radii radii(record.radii[0], record.radii[1], record.radii[2], record.radii[3]);
+        cocos2d::ccColor4B color = {record.color[0], record.color[1], record.color[2], record.color[3]};
+
+        switch (record.type) {
+            case NodeType::RoundedRect: {
+                node = RoundedRect::create(color, radii, {record.width, record.height});
+            } break;
+            case NodeType::RoundedSprite: {
+                auto name = this->getString(record.frameName);
+                if (!name) break;
+
+                RoundedSprite* sprite;
+                if (auto frame = cocos2d::CCSpriteFrameCache::sharedSpriteFrameCache()->spriteFrameByName(name)) {
+                    sprite = RoundedSprite::createWithSpriteFrame(frame, radii);
+                } else {
+                    sprite = RoundedSprite::create(name, radii);
+                }
+
+                if (sprite) {
+                    sprite->setColor({color.r, color.g, color.b});
+                    sprite->setOpacity(color.a);
+                }
+                node = sprite;
+            } break;
+            default: {
+                node = cocos2d::CCNode::create();
+                node->setContentSize({record.width, record.height});
+            } break;
+        }
+
+        if (!node) {
+            // keep the tree shape intact, so children still end up in the right place
+            geode::log::warn("Failed to create blueprint node (type {})", static_cast<int>(record.type));
+            node = cocos2d::CCNode::create();
+        }
+
+        node->setPosition({record.x, record.y});
+        node->setScaleX(record.scaleX);
+        node->setScaleY(record.scaleY);
+        node->setRotation(record.rotation);
+        node->setAnchorPoint({record.anchorX, record.anchorY});
+
+        return node;
+    }
+
+    cocos2d::CCNode* Blueprint::instantiate() const {
+        struct Parent {
+            cocos2d::CCNode* node;
+            uint32_t remaining;
+            bool reserved = false;
+        };
+
+        std::vector<Parent> parents;
+        cocos2d::CCNode* root = nullptr;
+
+        // single pass over pre-order records, parents wait on the stack until all of their children arrive
+        for (auto const& record : this->getNodes()) {
+            auto node = this->createNode(record);
+
+            if (parents.empty()) {
+                root = node;
+                root->setZOrder(record.zOrder);
+                root->setTag(record.tag);
+            } else {
+                auto& parent = parents.back();
+                parent.node->addChild(node, record.zOrder, record.tag);
+                parent.remaining--;
+
+                // children array is created by the first addChild, grow it once to the final size
+                if (!parent.reserved) {
+                    cocos2d::ccArrayEnsureExtraCapacity(parent.node->getChildren()->data, parent.remaining);
+                    parent.reserved = true;
+                }
+            }
+
+            if (record.childCount > 0) {
+                parents.push_back({node, record.childCount});
+            }
+
+            while (!parents.empty() && parents.back().remaining == 0) {
+                parents.pop_back();
+            }
+        }
+
+        return root;
+    }
+} // namespace rock
@@ -0,0 +1,209 @@
+#include <rock/CachedNode.hpp>
+#include <rock/Utils.hpp>
+
+#include <Geode/utils/casts.hpp>
+#include <Geode/utils/cocos.hpp>
+
+namespace rock {
+    static size_t s_memoryBudget = 32 * 1024 * 1024;
+    static size_t s_memoryUsage = 0;
+    // rock setters call invalidateAncestors all the time, most scenes don't have anything to invalidate
+    static size_t s_liveNodes = 0;
+
+    CachedNode::CachedNode() {
+        s_liveNodes++;
+    }
+
+    CachedNode::~CachedNode() {
+        this->releaseSurface();
+        s_liveNodes--;
+    }
+
+    CachedNode* CachedNode::create(cocos2d::CCSize const& size) {
+        auto ret = new CachedNode();
+        if (ret->init(size)) {
+            ret->autorelease();
+            return ret;
+        }
+        delete ret;
+        return nullptr;
+    }
+
+    CachedNode* CachedNode::create() {
+        return create(cocos2d::CCDirector::get()->getWinSize());
+    }
+
+    bool CachedNode::init(cocos2d::CCSize const& size) {
+        if (!CCNode::init()) {
+            return false;
+        }
+
+        this->setContentSize(size);
+        return true;
+    }
+
+    void CachedNode::invalidate() {
+        m_dirty = true;
+        invalidateAncestors(this);
+    }
+
+    bool CachedNode::isDirty() const {
+        return m_dirty;
+    }
+
+    void CachedNode::setCachingEnabled(bool enabled) {
+        m_cachingEnabled = enabled;
+        m_dirty = true;
+        if (!enabled) {
+            this->releaseSurface();
+        }
+    }
+
+    bool CachedNode::isCachingEnabled() const {
+        return m_cachingEnabled;
+    }
+
+    void CachedNode::invalidateAncestors(cocos2d::CCNode* node) {
+        if (s_liveNodes == 0) return;
+
+        // nested caches all contain the changed node, so every one of them is outdated
+        for (auto parent = node->getParent(); parent; parent = parent->getParent()) {
+            if (auto cached = geode::cast::typeinfo_cast<CachedNode*>(parent)) {
+                cached->m_dirty = true;
+            }
+        }
+    }
+
+    void CachedNode::setMemoryBudget(size_t bytes) {
+        s_memoryBudget = bytes;
+    }
+
+    size_t CachedNode::getMemoryBudget() {
+        return s_memoryBudget;
+    }
+
+    size_t CachedNode::getMemoryUsage() {
+        return s_memoryUsage;
+    }
+
+    bool CachedNode::ensureSurface() {
+        // surface texture is gone together with the old context
+        if (m_contextEpoch != util::getContextEpoch()) {
+            this->releaseSurface();
+            m_contextEpoch = util::getContextEpoch();
+        }
+
+        if (m_renderTexture) {
+            return true;
+        }
+
+        auto width = static_cast<int>(std::ceil(m_obContentSize.width));
+        auto height = static_cast<int>(std::ceil(m_obContentSize.height));
+        if (width <= 0 || height <= 0) {
+            return false;
+        }
+
+        auto scale = CC_CONTENT_SCALE_FACTOR();
+        auto bytes = static_cast<size_t>(width * scale) * static_cast<size_t>(height * scale) * 4;
+        if (s_memoryUsage + bytes > s_memoryBudget) {
+            return false;
+        }
+
+        auto renderTexture = cocos2d::CCRenderTexture::create(
+            width, height,
+            cocos2d::kCCTexture2DPixelFormat_RGBA8888
+        );
+
+        if (!renderTexture) {
+            return false;
+        }
+
+        // render texture sprite is flipped vertically around its center
+        auto sprite = renderTexture->getSprite();
+        auto spriteSize = sprite->getContentSize();
+        sprite->setPosition({spriteSize.width / 2.f, spriteSize.height / 2.f});
+        // rock components render premultiplied colors into the surface
+        sprite->setBlendFunc({GL_ONE, GL_ONE_MINUS_SRC_ALPHA});
+
+        m_renderTexture = renderTexture;
+        m_renderTexture->retain();
+        m_surfaceBytes = bytes;
+        s_memoryUsage += bytes;
+        m_dirty = true;
+
+        return true;
+    }
+
+    void CachedNode::releaseSurface() {
+        if (!m_renderTexture) return;
+
+        m_renderTexture->release();
+        m_renderTexture = nullptr;
+        s_memoryUsage -= m_surfaceBytes;
+        m_surfaceBytes = 0;
+        m_dirty = true;
+    }
+
+    void CachedNode::renderCache() {
+        m_renderTexture->beginWithClear(0.f, 0.f, 0.f, 0.f);
+
+        this->sortAllChildren();
+        for (auto child : geode::cocos::CCArrayExt<cocos2d::CCNode*>(this->getChildren())) {
+            child->visit();
+        }
+
+        m_renderTexture->end();
+        m_dirty = false;
+    }
+
+    void CachedNode::visit() {
+        if (!m_bVisible) return;
+
+        if (!m_cachingEnabled || !this->ensureSurface()) {
+            CCNode::visit();
+            return;
+        }
+
+        if (m_dirty) {
+            this->renderCache();
+        }
+
+        kmGLPushMatrix();
+        this->transform();
+        m_renderTexture->getSprite()->visit();
+        kmGLPopMatrix();
+    }
+
+    void CachedNode::onExit() {
+        // give the memory back to the budget while we're not on screen
+        this->releaseSurface();
+        CCNode::onExit();
+    }
+
+    void CachedNode::setContentSize(cocos2d::CCSize const& contentSize) {
+        if (contentSize.equals(m_obContentSize)) return;
+
+        CCNode::setContentSize(contentSize);
+        this->releaseSurface();
+    }
+
+    void CachedNode::addChild(cocos2d::CCNode* child, int zOrder, int tag) {
+        CCNode::addChild(child, zOrder, tag);
+        this->invalidate();
+    }
+
+    void CachedNode::removeChild(cocos2d::CCNode* child, bool cleanup) {
+        CCNode::removeChild(child, cleanup);
+        this->invalidate();
+    }
+
+    void CachedNode::removeAllChildrenWithCleanup(bool cleanup) {
+        CCNode::removeAllChildrenWithCleanup(cleanup);
+        this->invalidate();
+    }
+
+    void CachedNode::reorderChild(cocos2d::CCNode* child, int zOrder) {
+        CCNode::reorderChild(child, zOrder);
+        this->invalidate();
+    }
+} // namespace rock
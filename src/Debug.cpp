@@ -0,0 +1,156 @@
+#include <rock/Debug.hpp>
+#include <rock/RenderQueue.hpp>
+#include <rock/RoundedRect.hpp>
+
+#include <Geode/loader/Log.hpp>
+#include <Geode/utils/casts.hpp>
+#include <Geode/utils/cocos.hpp>
+
+#include <vector>
+
+namespace rock::debug {
+    static HeatmapMode s_heatmapMode = HeatmapMode::Off;
+
+    using NodeFilter = bool(*)(cocos2d::CCNode*);
+
+    template <typename T>
+    static bool isNodeOfType(cocos2d::CCNode* node) {
+        return geode::cast::typeinfo_cast<T*>(node) != nullptr;
+    }
+
+    double FragmentStats::getDiscardRatio() const {
+        return shaded > 0 ? static_cast<double>(discarded) / static_cast<double>(shaded) : 0.0;
+    }
+
+    double FragmentStats::getSlowPathRatio() const {
+        return shaded > 0 ? static_cast<double>(slowPath) / static_cast<double>(shaded) : 0.0;
+    }
+
+    double OverdrawReport::getAverageOverdraw() const {
+        if (coveredPixels == 0) return 0.0;
+        return static_cast<double>(rects.shaded + sprites.shaded) / static_cast<double>(coveredPixels);
+    }
+
+    void setHeatmapMode(HeatmapMode mode) {
+        // queued quads were recorded with the programs of the previous mode
+        RenderQueue::get()->flush();
+        s_heatmapMode = mode;
+    }
+
+    HeatmapMode getHeatmapMode() {
+        return s_heatmapMode;
+    }
+
+    // same order as CCNode::visit, but only nodes accepted by the filter are drawn
+    static void drawTree(cocos2d::CCNode* node, NodeFilter filter) {
+        if (!node->isVisible()) return;
+
+        kmGLPushMatrix();
+        node->transform();
+        node->sortAllChildren();
+
+        bool drawn = false;
+        for (auto child : geode::cocos::CCArrayExt<cocos2d::CCNode*>(node->getChildren())) {
+            if (!drawn && child->getZOrder() >= 0) {
+                if (filter(node)) node->draw();
+                drawn = true;
+            }
+            drawTree(child, filter);
+        }
+
+        if (!drawn && filter(node)) {
+            node->draw();
+        }
+
+        kmGLPopMatrix();
+    }
+
+    static void capturePass(
+        cocos2d::CCRenderTexture* target,
+        cocos2d::CCNode* root,
+        NodeFilter filter,
+        FragmentStats& stats,
+        std::vector<uint16_t>& overdraw,
+        std::vector<bool>& saturated
+    ) {
+        target->beginWithClear(0.f, 0.f, 0.f, 0.f);
+
+        kmGLMatrixMode(KM_GL_MODELVIEW);
+        kmGLPushMatrix();
+        kmGLLoadIdentity();
+        if (auto parent = root->getParent()) {
+            auto transform = parent->nodeToWorldTransform();
+            kmMat4 world;
+            cocos2d::CGAffineToGL(&transform, world.mat);
+            kmGLMultMatrix(&world);
+        }
+
+        drawTree(root, filter);
+
+        kmGLPopMatrix();
+        target->end();
+
+        auto image = target->newCCImage(false);
+        if (!image) {
+            geode::log::error("Failed to read back overdraw capture");
+            return;
+        }
+
+        auto data = image->getData();
+        size_t count = static_cast<size_t>(image->getWidth()) * image->getHeight();
+        overdraw.resize(count, 0);
+        saturated.resize(count, false);
+
+        for (size_t i = 0; i < count; ++i) {
+            auto pixel = data + i * 4;
+            stats.shaded += pixel[0];
+            stats.slowPath += pixel[1];
+            stats.discarded += pixel[2];
+
+            overdraw[i] += pixel[0];
+            // an 8-bit channel can't tell 255 fragments apart from more, so any full channel might be clamped
+            if (pixel[0] == 255 || pixel[1] == 255 || pixel[2] == 255) {
+                saturated[i] = true;
+            }
+        }
+
+        image->release();
+    }
+
+    OverdrawReport captureOverdraw(cocos2d::CCNode* root) {
+        OverdrawReport report;
+        if (!root) return report;
+
+        auto winSize = cocos2d::CCDirector::get()->getWinSize();
+        auto target = cocos2d::CCRenderTexture::create(
+            static_cast<int>(winSize.width),
+            static_cast<int>(winSize.height),
+            cocos2d::kCCTexture2DPixelFormat_RGBA8888
+        );
+
+        if (!target) {
+            geode::log::error("Failed to create overdraw capture target");
+            return report;
+        }
+
+        auto previousMode = s_heatmapMode;
+        setHeatmapMode(HeatmapMode::Capture);
+
+        // channels only hold counts for one pass, so every node type gets its own
+        std::vector<uint16_t> overdraw;
+        std::vector<bool> saturated;
+        capturePass(target, root, isNodeOfType<RoundedRect>, report.rects, overdraw, saturated);
+        capturePass(target, root, isNodeOfType<RoundedSprite>, report.sprites, overdraw, saturated);
+
+        setHeatmapMode(previousMode);
+
+        report.pixels = overdraw.size();
+        for (size_t i = 0; i < overdraw.size(); ++i) {
+            if (overdraw[i] > 0) report.coveredPixels++;
+            if (saturated[i]) report.saturatedPixels++;
+            report.maxOverdraw = std::max<unsigned>(report.maxOverdraw, overdraw[i]);
+        }
+
+        return report;
+    }
+} // namespace rock::debug
@@ -0,0 +1,455 @@
+#include <rock/Layout.hpp>
+#include <rock/CachedNode.hpp>
+#include <rock/RoundedRect.hpp>
+#include <rock/VirtualList.hpp>
+
+#include <Geode/utils/casts.hpp>
+#include <Geode/utils/cocos.hpp>
+
+namespace rock {
+    struct LayoutItem {
+        cocos2d::CCNode* node;
+        LayoutParams params;
+        float main;
+        float cross;
+    };
+
+    struct LayoutLine {
+        size_t begin = 0;
+        size_t end = 0;
+        float main = 0.f;
+        float cross = 0.f;
+    };
+
+    static float mainAxis(cocos2d::CCSize const& size, bool row) {
+        return row ? size.width : size.height;
+    }
+
+    static float crossAxis(cocos2d::CCSize const& size, bool row) {
+        return row ? size.height : size.width;
+    }
+
+    static cocos2d::CCSize fromAxes(float main, float cross, bool row) {
+        return row ? cocos2d::CCSize(main, cross) : cocos2d::CCSize(cross, main);
+    }
+
+    // rock nodes rebuild themselves for their content size. other nodes (sprites, labels, menus)
+    // don't draw any differently, so resizing them would only skew their anchor point placement
+    static bool isResizable(cocos2d::CCNode* node, LayoutParams const& params) {
+        if (params.resize) return *params.resize;
+
+        return geode::cast::typeinfo_cast<RoundedRect*>(node)
+            || geode::cast::typeinfo_cast<Layout*>(node)
+            || geode::cast::typeinfo_cast<CachedNode*>(node)
+            || geode::cast::typeinfo_cast<VirtualList*>(node);
+    }
+
+    // same shortcut as CachedNode::invalidateAncestors, rock setters notify layouts on every change
+    static size_t s_liveLayouts = 0;
+
+    Layout::Layout() {
+        s_liveLayouts++;
+    }
+
+    Layout::~Layout() {
+        s_liveLayouts--;
+    }
+
+    Layout* Layout::create(LayoutDirection direction) {
+        auto ret = new Layout();
+        if (ret->init(direction, {0.f, 0.f}, true)) {
+            ret->autorelease();
+            return ret;
+        }
+        delete ret;
+        return nullptr;
+    }
+
+    Layout* Layout::create(LayoutDirection direction, cocos2d::CCSize const& size) {
+        auto ret = new Layout();
+        if (ret->init(direction, size, false)) {
+            ret->autorelease();
+            return ret;
+        }
+        delete ret;
+        return nullptr;
+    }
+
+    bool Layout::init(LayoutDirection direction, cocos2d::CCSize const& size, bool autoSize) {
+        if (!CCNode::init()) {
+            return false;
+        }
+
+        m_direction = direction;
+        m_autoSize = autoSize;
+        this->setAnchorPoint({0.5f, 0.5f});
+        this->setContentSize(size);
+        return true;
+    }
+
+    void Layout::setDirection(LayoutDirection direction) {
+        if (m_direction == direction) return;
+        m_direction = direction;
+        this->markDirty();
+    }
+
+    LayoutDirection Layout::getDirection() const {
+        return m_direction;
+    }
+
+    void Layout::setWrap(bool wrap) {
+        if (m_wrap == wrap) return;
+        m_wrap = wrap;
+        this->markDirty();
+    }
+
+    bool Layout::isWrap() const {
+        return m_wrap;
+    }
+
+    void Layout::setGap(float gap) {
+        this->setGap(gap, gap);
+    }
+
+    void Layout::setGap(float gap, float lineGap) {
+        if (m_gap == gap && m_lineGap == lineGap) return;
+        m_gap = gap;
+        m_lineGap = lineGap;
+        this->markDirty();
+    }
+
+    float Layout::getGap() const {
+        return m_gap;
+    }
+
+    float Layout::getLineGap() const {
+        return m_lineGap;
+    }
+
+    void Layout::setPadding(Padding const& padding) {
+        m_padding = padding;
+        this->markDirty();
+    }
+
+    Padding const& Layout::getPadding() const {
+        return m_padding;
+    }
+
+    void Layout::setJustify(LayoutJustify justify) {
+        if (m_justify == justify) return;
+        m_justify = justify;
+        this->markDirty();
+    }
+
+    LayoutJustify Layout::getJustify() const {
+        return m_justify;
+    }
+
+    void Layout::setAlign(LayoutAlign align) {
+        if (m_align == align) return;
+        m_align = align;
+        this->markDirty();
+    }
+
+    LayoutAlign Layout::getAlign() const {
+        return m_align;
+    }
+
+    void Layout::setAutoSize(bool autoSize) {
+        if (m_autoSize == autoSize) return;
+        m_autoSize = autoSize;
+        this->markDirty();
+        invalidateParent(this);
+    }
+
+    bool Layout::isAutoSize() const {
+        return m_autoSize;
+    }
+
+    void Layout::setLayoutParams(cocos2d::CCNode* child, LayoutParams const& params) {
+        m_childInfo[child].params = params;
+        this->markDirty();
+    }
+
+    LayoutParams Layout::getLayoutParams(cocos2d::CCNode* child) const {
+        auto it = m_childInfo.find(child);
+        return it != m_childInfo.end() ? it->second.params : LayoutParams{};
+    }
+
+    void Layout::addChild(cocos2d::CCNode* child, LayoutParams const& params) {
+        m_childInfo[child].params = params;
+        this->addChild(child);
+    }
+
+    void Layout::markDirty() {
+        // children are moved and resized while the layout is applied, ignore their notifications
+        if (m_inLayout) return;
+
+        m_dirty = true;
+        m_measureValid = false;
+
+        // size of an auto-sized layout depends on its children, so the parent is affected as well
+        if (m_autoSize) {
+            invalidateParent(this);
+        }
+    }
+
+    bool Layout::isDirty() const {
+        return m_dirty;
+    }
+
+    void Layout::invalidateParent(cocos2d::CCNode* node) {
+        if (s_liveLayouts == 0) return;
+
+        if (auto layout = geode::cast::typeinfo_cast<Layout*>(node->getParent())) {
+            layout->childChanged(node);
+        }
+    }
+
+    void Layout::childChanged(cocos2d::CCNode* child) {
+        if (m_inLayout) return;
+
+        // the child was resized from outside, its current size is the one to lay out from now on
+        if (auto it = m_childInfo.find(child); it != m_childInfo.end()) {
+            it->second.resized = false;
+        }
+        this->markDirty();
+    }
+
+    cocos2d::CCSize Layout::getNaturalSize(cocos2d::CCNode* child) {
+        if (auto layout = geode::cast::typeinfo_cast<Layout*>(child); layout && layout->m_autoSize) {
+            return layout->measure();
+        }
+
+        auto const& size = child->getContentSize();
+        auto it = m_childInfo.find(child);
+        if (it != m_childInfo.end() && it->second.resized) {
+            // nodes that don't notify us could've been resized by someone else in the meantime
+            if (size.equals(it->second.assigned)) {
+                return it->second.natural;
+            }
+            it->second.resized = false;
+        }
+        return size;
+    }
+
+    cocos2d::CCSize Layout::getItemSize(cocos2d::CCNode* child) {
+        auto size = this->getNaturalSize(child);
+        return {size.width * std::abs(child->getScaleX()), size.height * std::abs(child->getScaleY())};
+    }
+
+    cocos2d::CCSize Layout::measure() {
+        if (m_measureValid) return m_measuredSize;
+
+        bool row = m_direction == LayoutDirection::Row;
+        float main = 0.f;
+        float cross = 0.f;
+        size_t count = 0;
+
+        for (auto child : geode::cocos::CCArrayExt<cocos2d::CCNode*>(this->getChildren())) {
+            if (!child->isVisible()) continue;
+
+            auto params = this->getLayoutParams(child);
+            auto size = this->getItemSize(child);
+            main += params.basis >= 0.f ? params.basis : mainAxis(size, row);
+            cross = std::max(cross, crossAxis(size, row));
+            count++;
+        }
+
+        if (count > 1) {
+            main += m_gap * static_cast<float>(count - 1);
+        }
+
+        main += row ? m_padding.left + m_padding.right : m_padding.top + m_padding.bottom;
+        cross += row ? m_padding.top + m_padding.bottom : m_padding.left + m_padding.right;
+
+        m_measuredSize = fromAxes(main, cross, row);
+        m_measureValid = true;
+        return m_measuredSize;
+    }
+
+    void Layout::relayout() {
+        if (!m_dirty) return;
+        m_inLayout = true;
+
+        // a parent Layout decides the final size of its children, it only uses our measured size as a basis
+        if (m_autoSize && !geode::cast::typeinfo_cast<Layout*>(m_pParent)) {
+            this->setContentSize(this->measure());
+        }
+
+        bool row = m_direction == LayoutDirection::Row;
+        auto const& size = this->getContentSize();
+        float innerMain = std::max(0.f, mainAxis(size, row) - (row ? m_padding.left + m_padding.right : m_padding.top + m_padding.bottom));
+        float innerCross = std::max(0.f, crossAxis(size, row) - (row ? m_padding.top + m_padding.bottom : m_padding.left + m_padding.right));
+
+        this->sortAllChildren();
+
+        std::vector<LayoutItem> items;
+        for (auto child : geode::cocos::CCArrayExt<cocos2d::CCNode*>(this->getChildren())) {
+            if (!child->isVisible()) continue;
+
+            auto params = this->getLayoutParams(child);
+            auto itemSize = this->getItemSize(child);
+            items.push_back({
+                child, params,
+                params.basis >= 0.f ? params.basis : mainAxis(itemSize, row),
+                crossAxis(itemSize, row)
+            });
+        }
+
+        // split children into lines
+        std::vector<LayoutLine> lines;
+        LayoutLine line;
+        bool wrap = m_wrap && !m_autoSize;
+        for (size_t i = 0; i < items.size(); ++i) {
+            auto const& item = items[i];
+            float gap = line.end > line.begin ? m_gap : 0.f;
+
+            if (wrap && line.end > line.begin && line.main + gap + item.main > innerMain) {
+                lines.push_back(line);
+                line = {i, i};
+                gap = 0.f;
+            }
+
+            line.main += gap + item.main;
+            line.cross = std::max(line.cross, item.cross);
+            line.end = i + 1;
+        }
+        if (line.end > line.begin) {
+            lines.push_back(line);
+        }
+
+        // a single line takes the whole cross axis, so children can be centered or stretched in it
+        if (lines.size() == 1) {
+            lines[0].cross = std::max(lines[0].cross, innerCross);
+        }
+
+        float lineOffset = 0.f;
+        for (auto const& line : lines) {
+            // distribute free space with grow factors, or take away overflow with shrink factors
+            float freeSpace = innerMain - line.main;
+            float totalGrow = 0.f;
+            float totalShrink = 0.f;
+            for (size_t i = line.begin; i < line.end; ++i) {
+                totalGrow += items[i].params.grow;
+                totalShrink += items[i].params.shrink * items[i].main;
+            }
+
+            float usedSpace = line.main;
+            for (size_t i = line.begin; i < line.end; ++i) {
+                auto& item = items[i];
+                float delta = 0.f;
+                if (freeSpace > 0.f && totalGrow > 0.f) {
+                    delta = freeSpace * item.params.grow / totalGrow;
+                } else if (freeSpace < 0.f && totalShrink > 0.f) {
+                    delta = std::max(-item.main, freeSpace * item.params.shrink * item.main / totalShrink);
+                }
+                item.main += delta;
+                usedSpace += delta;
+            }
+
+            float leftover = std::max(0.f, innerMain - usedSpace);
+            float offset = 0.f;
+            float spacing = m_gap;
+            size_t count = line.end - line.begin;
+            switch (m_justify) {
+                case LayoutJustify::Start: break;
+                case LayoutJustify::Center: offset = leftover / 2.f; break;
+                case LayoutJustify::End: offset = leftover; break;
+                case LayoutJustify::SpaceBetween: {
+                    if (count > 1) spacing += leftover / static_cast<float>(count - 1);
+                } break;
+            }
+
+            for (size_t i = line.begin; i < line.end; ++i) {
+                auto const& item = items[i];
+                auto node = item.node;
+
+                float cross = item.cross;
+                float crossOffset = 0.f;
+                switch (item.params.align.value_or(m_align)) {
+                    case LayoutAlign::Start: break;
+                    case LayoutAlign::Center: crossOffset = (line.cross - cross) / 2.f; break;
+                    case LayoutAlign::End: crossOffset = line.cross - cross; break;
+                    case LayoutAlign::Stretch: cross = line.cross; break;
+                }
+
+                // push the size only if it actually changed, so nodes don't rebuild their geometry for nothing
+                float scaleX = std::abs(node->getScaleX());
+                float scaleY = std::abs(node->getScaleY());
+                if (isResizable(node, item.params) && scaleX > 0.f && scaleY > 0.f) {
+                    auto outer = fromAxes(item.main, cross, row);
+                    cocos2d::CCSize target(outer.width / scaleX, outer.height / scaleY);
+                    if (!target.equals(node->getContentSize())) {
+                        auto& info = m_childInfo[node];
+                        if (!info.resized) {
+                            info.natural = this->getNaturalSize(node);
+                            info.resized = true;
+                        }
+                        info.assigned = target;
+                        node->setContentSize(target);
+                    }
+                }
+
+                // main axis goes left to right and top to bottom, lines are stacked from the top
+                auto outer = fromAxes(item.main, cross, row);
+                float mainPos = offset;
+                float crossPos = lineOffset + crossOffset;
+                float x = m_padding.left + (row ? mainPos : crossPos);
+                float y = size.height - m_padding.top - (row ? crossPos : mainPos) - outer.height;
+
+                if (!node->isIgnoreAnchorPointForPosition()) {
+                    auto const& anchor = node->getAnchorPoint();
+                    x += anchor.x * outer.width;
+                    y += anchor.y * outer.height;
+                }
+                node->setPosition({x, y});
+
+                offset += item.main + spacing;
+            }
+
+            lineOffset += line.cross + m_lineGap;
+        }
+
+        m_inLayout = false;
+        m_dirty = false;
+    }
+
+    void Layout::visit() {
+        this->relayout();
+        CCNode::visit();
+    }
+
+    void Layout::setContentSize(cocos2d::CCSize const& contentSize) {
+        if (contentSize.equals(m_obContentSize)) return;
+
+        CCNode::setContentSize(contentSize);
+        if (!m_inLayout) {
+            // children have to be rearranged in the new bounds, but our measured size stays the same
+            m_dirty = true;
+        }
+        invalidateParent(this);
+    }
+
+    void Layout::addChild(cocos2d::CCNode* child, int zOrder, int tag) {
+        CCNode::addChild(child, zOrder, tag);
+        this->markDirty();
+    }
+
+    void Layout::removeChild(cocos2d::CCNode* child, bool cleanup) {
+        m_childInfo.erase(child);
+        CCNode::removeChild(child, cleanup);
+        this->markDirty();
+    }
+
+    void Layout::removeAllChildrenWithCleanup(bool cleanup) {
+        m_childInfo.clear();
+        CCNode::removeAllChildrenWithCleanup(cleanup);
+        this->markDirty();
+    }
+
+    void Layout::reorderChild(cocos2d::CCNode* child, int zOrder) {
+        CCNode::reorderChild(child, zOrder);
+        this->markDirty();
+    }
+} // namespace rock
@@ -0,0 +1,367 @@
+#include <rock/RenderQueue.hpp>
+#include <rock/ThreadPool.hpp>
+#include <rock/Utils.hpp>
+
+#include <Geode/modify/CCClippingNode.hpp>
+#include <Geode/modify/CCDirector.hpp>
+#include <Geode/modify/CCEGLView.hpp>
+#include <Geode/modify/CCEGLViewProtocol.hpp>
+#include <Geode/modify/CCGLProgram.hpp>
+#include <Geode/modify/CCRenderTexture.hpp>
+#include <Geode/modify/CCScrollLayerExt.hpp>
+
+namespace rock {
+    // indices are 16-bit, so a single draw call can't address more vertices than this
+    constexpr size_t MAX_BATCH_QUADS = 65536 / 4;
+
+    // smaller batches aren't worth waking up the workers for
+    constexpr size_t PARALLEL_MIN_QUADS = 1024;
+    constexpr size_t PARALLEL_CHUNK_QUADS = 256;
+
+    constexpr std::array<cocos2d::ccTex2F, 4> LOCAL_UV = {{
+        {0.f, 0.f},
+        {1.f, 0.f},
+        {0.f, 1.f},
+        {1.f, 1.f}
+    }};
+
+    /// @brief Render target state shared by every quad of a batch
+    struct TargetInfo {
+        kmMat4 projection;
+        float viewportWidth;
+        float viewportHeight;
+    };
+
+    // runs on worker threads, so it can't touch anything in cocos
+    static void expandQuad(BatchQuad const& quad, kmMat4 const& mv, TargetInfo const& target, BatchVertex* out) {
+        auto pixelScale = util::getPixelScale(mv, target.projection, target.viewportWidth, target.viewportHeight);
+
+        for (size_t i = 0; i < 4; ++i) {
+            auto x = quad.positions[i].x;
+            auto y = quad.positions[i].y;
+            out[i] = {
+                {
+                    mv.mat[0] * x + mv.mat[4] * y + mv.mat[12],
+                    mv.mat[1] * x + mv.mat[5] * y + mv.mat[13],
+                    mv.mat[2] * x + mv.mat[6] * y + mv.mat[14],
+                },
+                quad.colors[i],
+                quad.texCoords[i],
+                LOCAL_UV[i],
+                quad.radii,
+                quad.size,
+                pixelScale
+            };
+        }
+    }
+
+    RenderQueue::RenderQueue() {
+        m_queued.reserve(256);
+        m_indices.reserve(MAX_BATCH_QUADS * 6);
+        for (size_t i = 0; i < MAX_BATCH_QUADS; ++i) {
+            auto base = static_cast<GLushort>(i * 4);
+            m_indices.push_back(base);
+            m_indices.push_back(base + 1);
+            m_indices.push_back(base + 2);
+            m_indices.push_back(base + 2);
+            m_indices.push_back(base + 1);
+            m_indices.push_back(base + 3);
+        }
+    }
+
+    RenderQueue* RenderQueue::get() {
+        static RenderQueue instance;
+        return &instance;
+    }
+
+    void RenderQueue::setEnabled(bool enabled) {
+        if (!enabled) {
+            this->flush();
+        }
+        m_enabled = enabled;
+    }
+
+    bool RenderQueue::isEnabled() const {
+        return m_enabled;
+    }
+
+    bool RenderQueue::isCompatible(
+        cocos2d::CCGLProgram* program,
+        cocos2d::ccBlendFunc blendFunc,
+        GLuint texture
+    ) const {
+        return m_program == program
+            && m_blendFunc.src == blendFunc.src
+            && m_blendFunc.dst == blendFunc.dst
+            && m_texture == texture;
+    }
+
+    void RenderQueue::submit(
+        cocos2d::CCGLProgram* program,
+        cocos2d::ccBlendFunc blendFunc,
+        GLuint texture,
+        BatchQuad const& quad
+    ) {
+        if (
+            !m_queued.empty() &&
+            (!this->isCompatible(program, blendFunc, texture) || m_queued.size() >= MAX_BATCH_QUADS)
+        ) {
+            this->flush();
+        }
+
+        m_program = program;
+        m_blendFunc = blendFunc;
+        m_texture = texture;
+
+        // the node transform gets baked into vertices on flush, so quads from different nodes can share a draw call
+        auto& queued = m_queued.emplace_back();
+        queued.quad = quad;
+        kmGLGetMatrix(KM_GL_MODELVIEW, &queued.transform);
+    }
+
+    void RenderQueue::setMaxThreads(size_t threads) {
+        m_maxThreads = threads;
+    }
+
+    size_t RenderQueue::getMaxThreads() const {
+        return m_maxThreads;
+    }
+
+    void RenderQueue::generateVertices(size_t count) {
+        // only ever grows, so every flush writes into memory that's already there
+        if (m_vertices.size() < count * 4) {
+            m_vertices.resize(count * 4);
+        }
+
+        // the queue is flushed before render targets change, so this is the target every quad was submitted for
+        TargetInfo target;
+        kmGLGetMatrix(KM_GL_PROJECTION, &target.projection);
+        auto viewport = util::getViewportSize();
+        target.viewportWidth = viewport.width;
+        target.viewportHeight = viewport.height;
+
+        auto generate = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                expandQuad(m_queued[i].quad, m_queued[i].transform, target, &m_vertices[i * 4]);
+            }
+        };
+
+        if (count < PARALLEL_MIN_QUADS || m_maxThreads == 1) {
+            generate(0, count);
+            return;
+        }
+
+        // every chunk writes its own range of the buffer, so workers never share anything they write to
+        ThreadPool::get()->parallelFor(count, PARALLEL_CHUNK_QUADS, generate, m_maxThreads);
+    }
+
+    void RenderQueue::uploadBuffers() {
+        // buffer names die with the context, the old ones can't be deleted anymore
+        if (!m_vertexBuffer || m_bufferEpoch != util::getContextEpoch()) {
+            glGenBuffers(1, &m_vertexBuffer);
+            glGenBuffers(1, &m_indexBuffer);
+            m_bufferEpoch = util::getContextEpoch();
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+            glBufferData(
+                GL_ELEMENT_ARRAY_BUFFER,
+                static_cast<GLsizeiptr>(m_indices.size() * sizeof(GLushort)),
+                m_indices.data(),
+                GL_STATIC_DRAW
+            );
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            static_cast<GLsizeiptr>(m_queued.size() * 4 * sizeof(BatchVertex)),
+            m_vertices.data(),
+            GL_STREAM_DRAW
+        );
+    }
+
+    void RenderQueue::flush() {
+        if (m_queued.empty() || m_flushing) return;
+        m_flushing = true;
+
+        auto quads = m_queued.size();
+        this->generateVertices(quads);
+
+        // vertices are already transformed, so only the projection is needed
+        kmGLMatrixMode(KM_GL_MODELVIEW);
+        kmGLPushMatrix();
+        kmGLLoadIdentity();
+        m_program->use();
+        m_program->setUniformsForBuiltins();
+        kmGLPopMatrix();
+
+        cocos2d::ccGLBlendFunc(m_blendFunc.src, m_blendFunc.dst);
+        if (m_texture) {
+            cocos2d::ccGLBindTexture2D(m_texture);
+        }
+
+        cocos2d::ccGLEnableVertexAttribs(cocos2d::kCCVertexAttribFlag_PosColorTex);
+        glEnableVertexAttribArray(util::VERTEX_ATTRIB_LOCAL_UV);
+        glEnableVertexAttribArray(util::VERTEX_ATTRIB_RADII);
+        glEnableVertexAttribArray(util::VERTEX_ATTRIB_SIZE);
+        glEnableVertexAttribArray(util::VERTEX_ATTRIB_PIXEL_SCALE);
+
+        this->uploadBuffers();
+
+        // attribute pointers are offsets into the vertex buffer
+        uintptr_t offset = 0;
+        glVertexAttribPointer(
+            cocos2d::kCCVertexAttrib_Position,
+            3, GL_FLOAT, GL_FALSE,
+            sizeof(BatchVertex),
+            reinterpret_cast<void*>(offset + offsetof(BatchVertex, position))
+        );
+        glVertexAttribPointer(
+            cocos2d::kCCVertexAttrib_Color,
+            4, GL_UNSIGNED_BYTE, GL_TRUE,
+            sizeof(BatchVertex),
+            reinterpret_cast<void*>(offset + offsetof(BatchVertex, color))
+        );
+        glVertexAttribPointer(
+            cocos2d::kCCVertexAttrib_TexCoords,
+            2, GL_FLOAT, GL_FALSE,
+            sizeof(BatchVertex),
+            reinterpret_cast<void*>(offset + offsetof(BatchVertex, texCoords))
+        );
+        glVertexAttribPointer(
+            util::VERTEX_ATTRIB_LOCAL_UV,
+            2, GL_FLOAT, GL_FALSE,
+            sizeof(BatchVertex),
+            reinterpret_cast<void*>(offset + offsetof(BatchVertex, localUV))
+        );
+        glVertexAttribPointer(
+            util::VERTEX_ATTRIB_RADII,
+            4, GL_FLOAT, GL_FALSE,
+            sizeof(BatchVertex),
+            reinterpret_cast<void*>(offset + offsetof(BatchVertex, radii))
+        );
+        glVertexAttribPointer(
+            util::VERTEX_ATTRIB_SIZE,
+            2, GL_FLOAT, GL_FALSE,
+            sizeof(BatchVertex),
+            reinterpret_cast<void*>(offset + offsetof(BatchVertex, size))
+        );
+        glVertexAttribPointer(
+            util::VERTEX_ATTRIB_PIXEL_SCALE,
+            1, GL_FLOAT, GL_FALSE,
+            sizeof(BatchVertex),
+            reinterpret_cast<void*>(offset + offsetof(BatchVertex, pixelScale))
+        );
+
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(quads * 6), GL_UNSIGNED_SHORT, nullptr);
+
+        // cocos draws from client-side arrays, which don't work with buffers bound
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        glDisableVertexAttribArray(util::VERTEX_ATTRIB_LOCAL_UV);
+        glDisableVertexAttribArray(util::VERTEX_ATTRIB_RADII);
+        glDisableVertexAttribArray(util::VERTEX_ATTRIB_SIZE);
+        glDisableVertexAttribArray(util::VERTEX_ATTRIB_PIXEL_SCALE);
+
+        m_drawCalls++;
+        m_quads += quads;
+        m_queued.clear();
+        m_flushing = false;
+    }
+
+    size_t RenderQueue::getDrawCalls() const {
+        return m_drawCalls;
+    }
+
+    size_t RenderQueue::getQuads() const {
+        return m_quads;
+    }
+
+    void RenderQueue::resetStats() {
+        m_drawCalls = 0;
+        m_quads = 0;
+    }
+} // namespace rock
+
+using namespace geode::prelude;
+
+// anything that draws through a shader program has to see our queued quads first
+class $modify(RockQueueGLProgram, CCGLProgram) {
+    void use() {
+        rock::RenderQueue::get()->flush();
+        CCGLProgram::use();
+    }
+};
+
+// render textures switch the framebuffer, projection and viewport
+class $modify(RockQueueRenderTexture, CCRenderTexture) {
+    void begin() {
+        rock::RenderQueue::get()->flush();
+        CCRenderTexture::begin();
+        rock::util::invalidateViewport();
+    }
+
+    void end() {
+        rock::RenderQueue::get()->flush();
+        CCRenderTexture::end();
+        rock::util::invalidateViewport();
+    }
+};
+
+// clipping nodes toggle stencil state around their children, so queued
+// quads wouldn't be clipped. draw everything inside of them immediately
+class $modify(RockQueueClippingNode, CCClippingNode) {
+    void visit() {
+        auto queue = rock::RenderQueue::get();
+        auto enabled = queue->isEnabled();
+        queue->setEnabled(false);
+        CCClippingNode::visit();
+        queue->setEnabled(enabled);
+    }
+};
+
+// scroll layers (and every list built on them) enable a scissor around their children and disable
+// it again before visit returns, with nothing to hook in between. draw their contents immediately
+class $modify(RockQueueScrollLayerExt, CCScrollLayerExt) {
+    void visit() {
+        auto queue = rock::RenderQueue::get();
+        auto enabled = queue->isEnabled();
+        queue->setEnabled(false);
+        CCScrollLayerExt::visit();
+        queue->setEnabled(enabled);
+    }
+};
+
+class $modify(RockQueueEGLViewProtocol, CCEGLViewProtocol) {
+    // quads queued before a new scissor rect must not be clipped by it
+    void setScissorInPoints(float x, float y, float w, float h) {
+        rock::RenderQueue::get()->flush();
+        CCEGLViewProtocol::setScissorInPoints(x, y, w, h);
+    }
+
+    // queued quads were expanded for the old viewport size
+    void setViewPortInPoints(float x, float y, float w, float h) {
+        rock::RenderQueue::get()->flush();
+        CCEGLViewProtocol::setViewPortInPoints(x, y, w, h);
+        rock::util::invalidateViewport();
+    }
+};
+
+// desktop and iOS swap buffers inside drawScene, android swaps after it returns
+class $modify(RockQueueEGLView, CCEGLView) {
+    void swapBuffers() {
+        rock::RenderQueue::get()->flush();
+        CCEGLView::swapBuffers();
+    }
+};
+
+class $modify(RockQueueDirector, CCDirector) {
+    void drawScene() {
+        // the window could've been resized, or someone called glViewport directly
+        rock::util::invalidateViewport();
+        CCDirector::drawScene();
+        rock::RenderQueue::get()->flush();
+    }
+};
@@ -1,6 +1,16 @@
 #include <rock/RoundedRect.hpp>
+#include <rock/CachedNode.hpp>
+#include <rock/Debug.hpp>
+#include <rock/Layout.hpp>
+#include <rock/RenderQueue.hpp>
+#include <rock/ThreadPool.hpp>
 #include <rock/Utils.hpp>
 
+#include <Geode/loader/Loader.hpp>
+#include <Geode/loader/Log.hpp>
+
+#include <string_view>
+
 namespace rock {
     namespace shaders {
         constexpr auto ROUNDED_RECT_VERT_SHADER = R"(attribute vec4 a_position;
@@ -15,10 +25,28 @@ varying vec4 v_fragmentColor;
 varying vec2 v_uv;
 #endif
 
+#ifdef ROCK_BATCHED
+attribute vec4 a_radii;
+attribute vec2 a_size;
+varying vec4 v_radii;
+varying vec2 v_size;
+#ifdef ROCK_ANALYTIC_AA
+attribute float a_pixelScale;
+varying float v_pixelScale;
+#endif
+#endif
+
 void main() {
     gl_Position = CC_MVPMatrix * a_position;
     v_fragmentColor = a_color;
     v_uv = a_texCoord;
+#ifdef ROCK_BATCHED
+    v_radii = a_radii;
+    v_size = a_size;
+#ifdef ROCK_ANALYTIC_AA
+    v_pixelScale = a_pixelScale;
+#endif
+#endif
 })";
 
         constexpr auto ROUNDED_RECT_FRAG_SHADER = R"(#ifdef GL_ES
@@ -27,8 +55,32 @@ precision lowp float;
 
 varying vec4 v_fragmentColor;
 varying vec2 v_uv;
+#ifdef ROCK_BATCHED
+varying vec4 v_radii;
+varying vec2 v_size;
+#define u_radii v_radii
+#define u_size v_size
+#else
 uniform vec4 u_radii;
 uniform vec2 u_size;
+#endif
+#ifdef ROCK_ANALYTIC_AA
+#ifdef ROCK_BATCHED
+varying float v_pixelScale;
+#define u_pixelScale v_pixelScale
+#else
+uniform float u_pixelScale;
+#endif
+#endif
+
+#ifdef ROCK_DEBUG_HEATMAP
+// drawn with additive blending: red counts every shaded fragment,
+// green the ones that took the per-corner path, blue the ones that would be discarded
+vec4 heatmapColor(float slowPath, float coverage) {
+    float discarded = coverage < 0.01 ? 1.0 : 0.0;
+    return vec4(1.0, slowPath, discarded, 0.0) * ROCK_HEAT_UNIT;
+}
+#endif
 
 float sdRoundRectFast(vec2 uv, vec2 size, float r) {
     r = min(r, min(size.x, size.y) * 0.5);
@@ -75,15 +127,30 @@ float sdRoundRect(vec2 uv, vec2 size, vec4 radii) {
 
 void main() {
     float dist;
+    float slowPath = 0.0;
     if (all(equal(u_radii.xyzw, u_radii.xxxx))) {
         dist = sdRoundRectFast(v_uv, u_size, u_radii.x);
     } else {
         dist = sdRoundRect(v_uv, u_size, u_radii);
+        slowPath = 1.0;
     }
+#ifdef ROCK_ANALYTIC_AA
+    // one pixel wide ramp across the edge, without derivatives or discard
+    float alpha = clamp(0.5 - dist * u_pixelScale, 0.0, 1.0);
+#else
     float aa = fwidth(dist);
     float alpha = 1.0 - smoothstep(-aa, aa, dist);
+#ifndef ROCK_DEBUG_HEATMAP
     if (alpha < 0.01) discard;
-    gl_FragColor = vec4(v_fragmentColor.rgb, v_fragmentColor.a * alpha);
+#endif
+#endif
+#ifdef ROCK_DEBUG_HEATMAP
+    gl_FragColor = heatmapColor(slowPath, alpha);
+#else
+    // premultiplied, so render targets accumulate coverage the same way blending on screen does
+    float a = v_fragmentColor.a * alpha;
+    gl_FragColor = vec4(v_fragmentColor.rgb * a, a);
+#endif
 })";
 
         constexpr auto ROUNDED_SPRITE_VERT_SHADER = R"(attribute vec4 a_position;
@@ -101,11 +168,29 @@ varying vec2 v_uv;
 varying vec2 v_localUV;
 #endif
 
+#ifdef ROCK_BATCHED
+attribute vec4 a_radii;
+attribute vec2 a_size;
+varying vec4 v_radii;
+varying vec2 v_size;
+#ifdef ROCK_ANALYTIC_AA
+attribute float a_pixelScale;
+varying float v_pixelScale;
+#endif
+#endif
+
 void main() {
     gl_Position = CC_MVPMatrix * a_position;
     v_fragmentColor = a_color;
     v_uv = a_texCoord;
     v_localUV = a_texCoord2;
+#ifdef ROCK_BATCHED
+    v_radii = a_radii;
+    v_size = a_size;
+#ifdef ROCK_ANALYTIC_AA
+    v_pixelScale = a_pixelScale;
+#endif
+#endif
 })";
 
         constexpr auto ROUNDED_SPRITE_FRAG_SHADER = R"(#ifdef GL_ES
@@ -115,10 +200,34 @@ precision lowp float;
 varying vec4 v_fragmentColor;
 varying vec2 v_uv;
 varying vec2 v_localUV;
+#ifdef ROCK_BATCHED
+varying vec4 v_radii;
+varying vec2 v_size;
+#define u_radii v_radii
+#define u_size v_size
+#else
 uniform vec4 u_radii;
 uniform vec2 u_size;
+#endif
+#ifdef ROCK_ANALYTIC_AA
+#ifdef ROCK_BATCHED
+varying float v_pixelScale;
+#define u_pixelScale v_pixelScale
+#else
+uniform float u_pixelScale;
+#endif
+#endif
 uniform sampler2D CC_Texture0;
 
+#ifdef ROCK_DEBUG_HEATMAP
+// drawn with additive blending: red counts every shaded fragment,
+// green the ones that took the per-corner path, blue the ones that would be discarded
+vec4 heatmapColor(float slowPath, float coverage) {
+    float discarded = coverage < 0.01 ? 1.0 : 0.0;
+    return vec4(1.0, slowPath, discarded, 0.0) * ROCK_HEAT_UNIT;
+}
+#endif
+
 float sdRoundRectFast(vec2 uv, vec2 size, float r) {
     r = min(r, min(size.x, size.y) * 0.5);
     vec2 halfSize = size * 0.5;
@@ -164,21 +273,132 @@ float sdRoundRect(vec2 uv, vec2 size, vec4 radii) {
 
 void main() {
     float dist;
+    float slowPath = 0.0;
     if (all(equal(u_radii.xyzw, u_radii.xxxx))) {
         dist = sdRoundRectFast(v_localUV, u_size, u_radii.x);
     } else {
         dist = sdRoundRect(v_localUV, u_size, u_radii);
+        slowPath = 1.0;
     }
+#ifdef ROCK_ANALYTIC_AA
+    float mask = clamp(0.5 - dist * u_pixelScale, 0.0, 1.0);
+#else
     float aa = fwidth(dist);
     float mask = 1.0 - smoothstep(-aa, aa, dist);
+#ifndef ROCK_DEBUG_HEATMAP
     if (mask < 0.01) discard;
+#endif
+#endif
+#ifdef ROCK_DEBUG_HEATMAP
+    gl_FragColor = heatmapColor(slowPath, mask);
+#else
     vec4 texColor = texture2D(CC_Texture0, v_uv);
     vec3 rgb = texColor.rgb * v_fragmentColor.rgb * mask;
     float a = texColor.a * v_fragmentColor.a * mask;
     gl_FragColor = vec4(rgb, a);
+#endif
 })";
     }
 
+    constexpr std::array<cocos2d::ccTex2F, 4> QUAD_UV = {{
+        {0.f, 0.f},
+        {1.f, 0.f},
+        {0.f, 1.f},
+        {1.f, 1.f}
+    }};
+
+    static AntiAliasMode s_defaultAntiAliasMode = AntiAliasMode::Derivative;
+
+    void setDefaultAntiAliasMode(AntiAliasMode mode) {
+        s_defaultAntiAliasMode = mode == AntiAliasMode::Inherit ? AntiAliasMode::Derivative : mode;
+    }
+
+    AntiAliasMode getDefaultAntiAliasMode() {
+        return s_defaultAntiAliasMode;
+    }
+
+    static AntiAliasMode resolveAntiAliasMode(AntiAliasMode mode) {
+        return mode == AntiAliasMode::Inherit ? s_defaultAntiAliasMode : mode;
+    }
+
+    // one program per combination of batching, anti-aliasing mode and heatmap mode
+    constexpr size_t PROGRAM_VARIANTS = 2 * 2 * 3;
+
+    // every fragment adds to the heat, instead of blending over what's underneath
+    constexpr cocos2d::ccBlendFunc HEATMAP_BLEND_FUNC = {GL_ONE, GL_ONE};
+
+    struct ProgramVariants {
+        std::array<std::string, PROGRAM_VARIANTS> names;
+        std::array<std::string, PROGRAM_VARIANTS> defines;
+
+        explicit ProgramVariants(std::string_view baseName) {
+            for (size_t i = 0; i < PROGRAM_VARIANTS; ++i) {
+                auto& name = names[i];
+                auto& define = defines[i];
+                name = baseName;
+
+                if (i & 1) {
+                    name += "_batched";
+                    define += "#define ROCK_BATCHED\n";
+                }
+                if (i & 2) {
+                    name += "_analytic";
+                    define += "#define ROCK_ANALYTIC_AA\n";
+                }
+                switch (static_cast<debug::HeatmapMode>(i / 4)) {
+                    case debug::HeatmapMode::Off: break;
+                    case debug::HeatmapMode::Live: {
+                        name += "_heatmap";
+                        define += "#define ROCK_DEBUG_HEATMAP\n#define ROCK_HEAT_UNIT (1.0 / 16.0)\n";
+                    } break;
+                    case debug::HeatmapMode::Capture: {
+                        name += "_heatmap_capture";
+                        define += "#define ROCK_DEBUG_HEATMAP\n#define ROCK_HEAT_UNIT (1.0 / 255.0)\n";
+                    } break;
+                }
+            }
+        }
+    };
+
+    static size_t getProgramVariant(bool batched, AntiAliasMode mode) {
+        return (batched ? 1 : 0)
+            | (mode == AntiAliasMode::Analytic ? 2 : 0)
+            | static_cast<size_t>(debug::getHeatmapMode()) * 4;
+    }
+
+    static cocos2d::CCGLProgram* getRectProgram(size_t variant) {
+        static ProgramVariants variants("rock_rounded_rect");
+        return util::getShaderProgram(
+            variants.names[variant].c_str(),
+            shaders::ROUNDED_RECT_VERT_SHADER,
+            shaders::ROUNDED_RECT_FRAG_SHADER,
+            variants.defines[variant].c_str()
+        );
+    }
+
+    static cocos2d::CCGLProgram* getSpriteProgram(size_t variant) {
+        static ProgramVariants variants("rock_rounded_sprite");
+        return util::getShaderProgram(
+            variants.names[variant].c_str(),
+            shaders::ROUNDED_SPRITE_VERT_SHADER,
+            shaders::ROUNDED_SPRITE_FRAG_SHADER,
+            variants.defines[variant].c_str()
+        );
+    }
+
+    static cocos2d::ccBlendFunc getDrawBlendFunc(cocos2d::ccBlendFunc blendFunc) {
+        return debug::getHeatmapMode() == debug::HeatmapMode::Off ? blendFunc : HEATMAP_BLEND_FUNC;
+    }
+
+    // rect colors leave the shader premultiplied, so alpha must not be applied to them again.
+    // GL_ONE also stores a + dst * (1 - a) as alpha, instead of a² with GL_SRC_ALPHA
+    static cocos2d::ccBlendFunc getRectBlendFunc(cocos2d::ccBlendFunc blendFunc) {
+        if (blendFunc.src == GL_SRC_ALPHA) {
+            blendFunc.src = GL_ONE;
+        }
+        return getDrawBlendFunc(blendFunc);
+    }
+
     RoundedRect::~RoundedRect() = default;
 
     RoundedRect* RoundedRect::create(
@@ -213,26 +433,43 @@ void main() {
 
     void RoundedRect::setRadii(Radii const& radii) {
         m_radii = radii;
+        CachedNode::invalidateAncestors(this);
     }
 
     void RoundedRect::setRadius(float radius) {
-        m_radii = Radii::uniform(radius);
+        this->setRadii(Radii::uniform(radius));
     }
 
     Radii const& RoundedRect::getRadii() const {
         return m_radii;
     }
 
+    void RoundedRect::setAntiAliasMode(AntiAliasMode mode) {
+        m_antiAliasMode = mode;
+        CachedNode::invalidateAncestors(this);
+    }
+
+    AntiAliasMode RoundedRect::getAntiAliasMode() const {
+        return m_antiAliasMode;
+    }
+
     bool RoundedRect::init(cocos2d::ccColor4B color, Radii const& radii, cocos2d::CCSize const& size) {
         if (!CCNodeRGBA::init()) {
             return false;
         }
 
-        auto shader = util::getShaderProgram(
-            "rock_rounded_rect",
-            shaders::ROUNDED_RECT_VERT_SHADER,
-            shaders::ROUNDED_RECT_FRAG_SHADER
-        );
+        this->setAnchorPoint({0.5f, 0.5f});
+        this->setContentSize(size);
+        this->setColor({color.r, color.g, color.b});
+        this->setOpacity(color.a);
+        m_radii = radii;
+
+        return true;
+    }
+
+    bool RoundedRect::reloadShader() {
+        auto variant = getProgramVariant(false, resolveAntiAliasMode(m_antiAliasMode));
+        auto shader = getRectProgram(variant);
 
         if (!shader) {
             return false;
@@ -240,26 +477,38 @@ void main() {
 
         this->setShaderProgram(shader);
 
-        this->setAnchorPoint({0.5f, 0.5f});
-        this->setContentSize(size);
-        this->setColor({color.r, color.g, color.b});
-        this->setOpacity(color.a);
-        m_radii = radii;
-
         m_radiiLoc = m_pShaderProgram->getUniformLocationForName("u_radii");
         m_sizeLoc = m_pShaderProgram->getUniformLocationForName("u_size");
+        m_pixelScaleLoc = m_pShaderProgram->getUniformLocationForName("u_pixelScale");
+        m_contextEpoch = util::getContextEpoch();
+        m_shaderVariant = variant;
 
         return true;
     }
 
     void RoundedRect::draw() {
-        if (!m_pShaderProgram) return;
+        auto mode = resolveAntiAliasMode(m_antiAliasMode);
+
+        auto queue = RenderQueue::get();
+        if (queue->isEnabled()) {
+            if (auto program = getRectProgram(getProgramVariant(true, mode))) {
+                queue->submit(program, getRectBlendFunc(m_blendFunc), 0, this->makeBatchQuad());
+                return;
+            }
+        }
+
+        // the immediate program is only resolved here, so nodes that are always batched never compile it.
+        // it's reloaded after a context loss (uniform locations might've changed),
+        // or when the global anti-aliasing or heatmap mode was switched
+        auto variant = getProgramVariant(false, mode);
+        if ((m_contextEpoch != util::getContextEpoch() || m_shaderVariant != variant) && !this->reloadShader()) return;
 
         ccGLEnable(m_eGLServerState);
         m_pShaderProgram->use();
         m_pShaderProgram->setUniformsForBuiltins();
 
-        cocos2d::ccGLBlendFunc(m_blendFunc.src, m_blendFunc.dst);
+        auto blendFunc = getRectBlendFunc(m_blendFunc);
+        cocos2d::ccGLBlendFunc(blendFunc.src, blendFunc.dst);
         auto size = this->getContentSize();
 
         m_pShaderProgram->setUniformLocationWith4f(
@@ -276,6 +525,10 @@ void main() {
             size.height
         );
 
+        if (mode == AntiAliasMode::Analytic) {
+            m_pShaderProgram->setUniformLocationWith1f(m_pixelScaleLoc, util::getPixelScale());
+        }
+
         cocos2d::ccGLEnableVertexAttribs(cocos2d::kCCVertexAttribFlag_PosColorTex);
         constexpr std::array<cocos2d::ccVertex2F, 4> texCoords = {{
             {0.f, 0.f},
@@ -303,6 +556,18 @@ void main() {
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
     }
 
+    BatchQuad RoundedRect::makeBatchQuad() const {
+        BatchQuad quad;
+        for (size_t i = 0; i < 4; ++i) {
+            quad.positions[i] = m_squareVertices[i];
+            quad.colors[i] = cocos2d::ccc4BFromccc4F(m_squareColors[i]);
+            quad.texCoords[i] = QUAD_UV[i];
+        }
+        quad.radii = {m_radii.topLeft, m_radii.topRight, m_radii.bottomRight, m_radii.bottomLeft};
+        quad.size = {m_obContentSize.width, m_obContentSize.height};
+        return quad;
+    }
+
     void RoundedRect::updateColor() {
         for (size_t i = 0; i < 4; ++i) {
             m_squareColors[i] = {
@@ -332,19 +597,67 @@ void main() {
     void RoundedRect::setColor(cocos2d::ccColor3B const& color) {
         CCNodeRGBA::setColor(color);
         this->updateColor();
+        CachedNode::invalidateAncestors(this);
     }
 
     void RoundedRect::setOpacity(GLubyte opacity) {
         CCNodeRGBA::setOpacity(opacity);
         this->updateColor();
+        CachedNode::invalidateAncestors(this);
     }
 
     void RoundedRect::setContentSize(cocos2d::CCSize const& contentSize) {
+        // layouts push sizes every time they're recalculated, don't rebuild vertices for nothing
+        if (contentSize.equals(m_obContentSize)) return;
+
         CCNode::setContentSize(contentSize);
         this->updateVertices();
+        CachedNode::invalidateAncestors(this);
+        Layout::invalidateParent(this);
+    }
+
+    void RoundedRect::setPosition(cocos2d::CCPoint const& position) {
+        CCNodeRGBA::setPosition(position);
+        CachedNode::invalidateAncestors(this);
+    }
+
+    void RoundedRect::setRotation(float rotation) {
+        CCNodeRGBA::setRotation(rotation);
+        CachedNode::invalidateAncestors(this);
+    }
+
+    void RoundedRect::setScale(float scale) {
+        CCNodeRGBA::setScale(scale);
+        CachedNode::invalidateAncestors(this);
+        Layout::invalidateParent(this);
+    }
+
+    void RoundedRect::setScaleX(float scaleX) {
+        CCNodeRGBA::setScaleX(scaleX);
+        CachedNode::invalidateAncestors(this);
+        Layout::invalidateParent(this);
+    }
+
+    void RoundedRect::setScaleY(float scaleY) {
+        CCNodeRGBA::setScaleY(scaleY);
+        CachedNode::invalidateAncestors(this);
+        Layout::invalidateParent(this);
+    }
+
+    void RoundedRect::setAnchorPoint(cocos2d::CCPoint const& anchorPoint) {
+        CCNodeRGBA::setAnchorPoint(anchorPoint);
+        CachedNode::invalidateAncestors(this);
     }
 
-    RoundedSprite::~RoundedSprite() = default;
+    void RoundedRect::setVisible(bool visible) {
+        CCNodeRGBA::setVisible(visible);
+        CachedNode::invalidateAncestors(this);
+        Layout::invalidateParent(this);
+    }
+
+    RoundedSprite::~RoundedSprite() {
+        CC_SAFE_RELEASE(m_placeholder);
+    }
 
     RoundedSprite* RoundedSprite::create(char const* filename, Radii const& radii) {
         auto ret = new RoundedSprite();
@@ -411,6 +724,28 @@ void main() {
         return createWithTexture(texture, Radii::uniform(radius));
     }
 
+    RoundedSprite* RoundedSprite::createAsync(
+        char const* filename,
+        Radii const& radii,
+        cocos2d::CCSize const& placeholderSize
+    ) {
+        auto ret = new RoundedSprite();
+        if (ret->initAsync(filename, radii, placeholderSize)) {
+            ret->autorelease();
+            return ret;
+        }
+        delete ret;
+        return nullptr;
+    }
+
+    RoundedSprite* RoundedSprite::createAsync(
+        char const* filename,
+        float radius,
+        cocos2d::CCSize const& placeholderSize
+    ) {
+        return createAsync(filename, Radii::uniform(radius), placeholderSize);
+    }
+
     bool RoundedSprite::initWithTexture(cocos2d::CCTexture2D* texture, Radii const& radii) {
         if (!CCSprite::initWithTexture(texture)) {
             return false;
@@ -443,13 +778,122 @@ void main() {
         return this->init(radii);
     }
 
+    bool RoundedSprite::initAsync(
+        char const* filename,
+        Radii const& radii,
+        cocos2d::CCSize const& placeholderSize
+    ) {
+        // already loaded textures don't need a round trip through the thread pool
+        if (auto texture = cocos2d::CCTextureCache::sharedTextureCache()->textureForKey(filename)) {
+            return this->initWithTexture(texture, radii);
+        }
+
+        if (!CCSprite::init()) {
+            return false;
+        }
+
+        if (!this->init(radii)) {
+            return false;
+        }
+
+        m_placeholder = RoundedRect::create(m_placeholderColor, radii, placeholderSize);
+        if (!m_placeholder) {
+            return false;
+        }
+
+        m_placeholder->retain();
+        m_placeholder->setAnchorPoint({0.f, 0.f});
+        this->setContentSize(placeholderSize);
+
+        // fullPathForFilename is not thread-safe, so resolve it here.
+        // the worker only decodes, texture upload has to happen on the main thread
+        std::string path = cocos2d::CCFileUtils::sharedFileUtils()->fullPathForFilename(filename, false);
+        this->retain();
+        ThreadPool::get()->submit([this, path] {
+            auto image = new cocos2d::CCImage();
+            if (!image->initWithImageFileThreadSafe(path.c_str(), util::getImageFormat(path))) {
+                image->release();
+                image = nullptr;
+            }
+
+            geode::queueInMainThread([this, image, path] {
+                this->onImageLoaded(image, path);
+                this->release();
+            });
+        });
+
+        return true;
+    }
+
+    void RoundedSprite::onImageLoaded(cocos2d::CCImage* image, std::string const& path) {
+        // the placeholder stays, callers can tell from isLoaded() and fall back to something else
+        if (!image) {
+            geode::log::error("Failed to load image {}", path);
+            m_loadFailed = true;
+            if (m_loadCallback) m_loadCallback(this);
+            return;
+        }
+
+        auto texture = cocos2d::CCTextureCache::sharedTextureCache()->addUIImage(image, path.c_str());
+        image->release();
+
+        if (!texture) {
+            geode::log::error("Failed to create texture for {}", path);
+            m_loadFailed = true;
+            if (m_loadCallback) m_loadCallback(this);
+            return;
+        }
+
+        CC_SAFE_RELEASE_NULL(m_placeholder);
+        this->setTexture(texture);
+        auto size = texture->getContentSize();
+        this->setTextureRect({0.f, 0.f, size.width, size.height});
+        CachedNode::invalidateAncestors(this);
+
+        if (m_loadCallback) {
+            m_loadCallback(this);
+        }
+    }
+
+    bool RoundedSprite::isLoaded() const {
+        return m_pobTexture != nullptr;
+    }
+
+    void RoundedSprite::setPlaceholderColor(cocos2d::ccColor4B const& color) {
+        m_placeholderColor = color;
+        if (m_placeholder) {
+            m_placeholder->setColor({color.r, color.g, color.b});
+            m_placeholder->setOpacity(color.a * _displayedOpacity / 255);
+            CachedNode::invalidateAncestors(this);
+        }
+    }
+
+    cocos2d::ccColor4B const& RoundedSprite::getPlaceholderColor() const {
+        return m_placeholderColor;
+    }
+
+    void RoundedSprite::setLoadCallback(std::function<void(RoundedSprite*)> callback) {
+        m_loadCallback = std::move(callback);
+
+        // cached textures are used right away, and loading might've failed already.
+        // call it on the next frame, like it would be after an actual load
+        if (m_loadCallback && (this->isLoaded() || m_loadFailed)) {
+            this->retain();
+            geode::queueInMainThread([this] {
+                if (m_loadCallback) m_loadCallback(this);
+                this->release();
+            });
+        }
+    }
+
     bool RoundedSprite::init(Radii const& radii) {
         m_radii = radii;
-        auto shader = util::getShaderProgram(
-            "rock_rounded_sprite",
-            shaders::ROUNDED_SPRITE_VERT_SHADER,
-            shaders::ROUNDED_SPRITE_FRAG_SHADER
-        );
+        return true;
+    }
+
+    bool RoundedSprite::reloadShader() {
+        auto variant = getProgramVariant(false, resolveAntiAliasMode(m_antiAliasMode));
+        auto shader = getSpriteProgram(variant);
 
         if (!shader) {
             return false;
@@ -459,18 +903,41 @@ void main() {
 
         m_radiiLoc = m_pShaderProgram->getUniformLocationForName("u_radii");
         m_sizeLoc = m_pShaderProgram->getUniformLocationForName("u_size");
+        m_pixelScaleLoc = m_pShaderProgram->getUniformLocationForName("u_pixelScale");
+        m_contextEpoch = util::getContextEpoch();
+        m_shaderVariant = variant;
 
         return true;
     }
 
     void RoundedSprite::draw() {
-        if (!m_pShaderProgram) return;
+        if (!m_pobTexture) {
+            if (m_placeholder) {
+                m_placeholder->visit();
+            }
+            return;
+        }
+
+        auto mode = resolveAntiAliasMode(m_antiAliasMode);
+
+        auto queue = RenderQueue::get();
+        if (queue->isEnabled()) {
+            if (auto program = getSpriteProgram(getProgramVariant(true, mode))) {
+                queue->submit(program, getDrawBlendFunc(m_sBlendFunc), m_pobTexture->getName(), this->makeBatchQuad());
+                return;
+            }
+        }
+
+        // same as RoundedRect, the immediate program is only resolved when it's needed
+        auto variant = getProgramVariant(false, mode);
+        if ((m_contextEpoch != util::getContextEpoch() || m_shaderVariant != variant) && !this->reloadShader()) return;
 
         ccGLEnable(m_eGLServerState);
         m_pShaderProgram->use();
         m_pShaderProgram->setUniformsForBuiltins();
 
-        cocos2d::ccGLBlendFunc(m_sBlendFunc.src, m_sBlendFunc.dst);
+        auto blendFunc = getDrawBlendFunc(m_sBlendFunc);
+        cocos2d::ccGLBlendFunc(blendFunc.src, blendFunc.dst);
         auto size = this->getContentSize();
 
         m_pShaderProgram->setUniformLocationWith4f(
@@ -487,6 +954,10 @@ void main() {
             size.height
         );
 
+        if (mode == AntiAliasMode::Analytic) {
+            m_pShaderProgram->setUniformLocationWith1f(m_pixelScaleLoc, util::getPixelScale());
+        }
+
         cocos2d::ccGLBindTexture2D(m_pobTexture->getName());
         cocos2d::ccGLEnableVertexAttribs(cocos2d::kCCVertexAttribFlag_PosColorTex);
 
@@ -517,9 +988,9 @@ void main() {
             reinterpret_cast<void*>(offset + offsetof(cocos2d::ccV3F_C4B_T2F, texCoords))
         );
 
-        glEnableVertexAttribArray(3);
+        glEnableVertexAttribArray(util::VERTEX_ATTRIB_LOCAL_UV);
         glVertexAttribPointer(
-            3,
+            util::VERTEX_ATTRIB_LOCAL_UV,
             2, GL_FLOAT, GL_FALSE,
             0,
             localUV.data()
@@ -527,18 +998,114 @@ void main() {
 
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-        glDisableVertexAttribArray(3);
+        glDisableVertexAttribArray(util::VERTEX_ATTRIB_LOCAL_UV);
+    }
+
+    BatchQuad RoundedSprite::makeBatchQuad() const {
+        // same vertex order as the quad memory layout drawn as a triangle strip
+        std::array<cocos2d::ccV3F_C4B_T2F const*, 4> corners = {
+            &m_sQuad.tl, &m_sQuad.bl, &m_sQuad.tr, &m_sQuad.br
+        };
+
+        BatchQuad quad;
+        for (size_t i = 0; i < 4; ++i) {
+            quad.positions[i] = {corners[i]->vertices.x, corners[i]->vertices.y};
+            quad.colors[i] = corners[i]->colors;
+            quad.texCoords[i] = corners[i]->texCoords;
+        }
+        quad.radii = {m_radii.topRight, m_radii.bottomRight, m_radii.bottomLeft, m_radii.topLeft};
+        quad.size = {m_obContentSize.width, m_obContentSize.height};
+        return quad;
     }
 
     void RoundedSprite::setRadii(Radii const& radii) {
         m_radii = radii;
+        if (m_placeholder) {
+            m_placeholder->setRadii(radii);
+        }
+        CachedNode::invalidateAncestors(this);
     }
 
     void RoundedSprite::setRadius(float radius) {
-        m_radii = Radii::uniform(radius);
+        this->setRadii(Radii::uniform(radius));
     }
 
     Radii const& RoundedSprite::getRadii() const {
         return m_radii;
     }
+
+    void RoundedSprite::setAntiAliasMode(AntiAliasMode mode) {
+        m_antiAliasMode = mode;
+        if (m_placeholder) {
+            m_placeholder->setAntiAliasMode(mode);
+        }
+        CachedNode::invalidateAncestors(this);
+    }
+
+    AntiAliasMode RoundedSprite::getAntiAliasMode() const {
+        return m_antiAliasMode;
+    }
+
+    void RoundedSprite::setColor(cocos2d::ccColor3B const& color) {
+        CCSprite::setColor(color);
+        CachedNode::invalidateAncestors(this);
+    }
+
+    void RoundedSprite::setOpacity(GLubyte opacity) {
+        CCSprite::setOpacity(opacity);
+        if (m_placeholder) {
+            m_placeholder->setOpacity(m_placeholderColor.a * _displayedOpacity / 255);
+        }
+        CachedNode::invalidateAncestors(this);
+    }
+
+    void RoundedSprite::setContentSize(cocos2d::CCSize const& contentSize) {
+        if (contentSize.equals(m_obContentSize)) return;
+
+        CCSprite::setContentSize(contentSize);
+        if (m_placeholder) {
+            m_placeholder->setContentSize(contentSize);
+        }
+        CachedNode::invalidateAncestors(this);
+        Layout::invalidateParent(this);
+    }
+
+    void RoundedSprite::setPosition(cocos2d::CCPoint const& position) {
+        CCSprite::setPosition(position);
+        CachedNode::invalidateAncestors(this);
+    }
+
+    void RoundedSprite::setRotation(float rotation) {
+        CCSprite::setRotation(rotation);
+        CachedNode::invalidateAncestors(this);
+    }
+
+    void RoundedSprite::setScale(float scale) {
+        CCSprite::setScale(scale);
+        CachedNode::invalidateAncestors(this);
+        Layout::invalidateParent(this);
+    }
+
+    void RoundedSprite::setScaleX(float scaleX) {
+        CCSprite::setScaleX(scaleX);
+        CachedNode::invalidateAncestors(this);
+        Layout::invalidateParent(this);
+    }
+
+    void RoundedSprite::setScaleY(float scaleY) {
+        CCSprite::setScaleY(scaleY);
+        CachedNode::invalidateAncestors(this);
+        Layout::invalidateParent(this);
+    }
+
+    void RoundedSprite::setAnchorPoint(cocos2d::CCPoint const& anchorPoint) {
+        CCSprite::setAnchorPoint(anchorPoint);
+        CachedNode::invalidateAncestors(this);
+    }
+
+    void RoundedSprite::setVisible(bool visible) {
+        CCSprite::setVisible(visible);
+        CachedNode::invalidateAncestors(this);
+        Layout::invalidateParent(this);
+    }
 } // namespace rock
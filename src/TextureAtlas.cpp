@@ -0,0 +1,439 @@
+#include <rock/TextureAtlas.hpp>
+#include <rock/RenderQueue.hpp>
+#include <rock/ThreadPool.hpp>
+#include <rock/Utils.hpp>
+
+#include <Geode/loader/Loader.hpp>
+#include <Geode/loader/Log.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace rock {
+    using Region = TextureAtlas::Region;
+
+    // best area fit, ties go to the region that leaves the shorter side smaller
+    static bool findFreeRegion(std::vector<Region> const& freeRegions, unsigned width, unsigned height, size_t& index) {
+        bool found = false;
+        size_t bestArea = 0;
+        unsigned bestShortSide = 0;
+
+        for (size_t i = 0; i < freeRegions.size(); ++i) {
+            auto const& region = freeRegions[i];
+            if (region.width < width || region.height < height) continue;
+
+            auto area = static_cast<size_t>(region.width) * region.height;
+            auto shortSide = std::min(region.width - width, region.height - height);
+            if (!found || area < bestArea || (area == bestArea && shortSide < bestShortSide)) {
+                found = true;
+                index = i;
+                bestArea = area;
+                bestShortSide = shortSide;
+            }
+        }
+
+        return found;
+    }
+
+    // places the image in the top-left corner of the free region and splits the rest in two,
+    // cutting along the shorter leftover axis so the bigger piece stays as large as possible
+    static Region takeFreeRegion(std::vector<Region>& freeRegions, size_t index, unsigned width, unsigned height) {
+        auto free = freeRegions[index];
+        freeRegions[index] = freeRegions.back();
+        freeRegions.pop_back();
+
+        auto leftoverWidth = free.width - width;
+        auto leftoverHeight = free.height - height;
+
+        Region right, bottom;
+        if (leftoverWidth < leftoverHeight) {
+            right = {free.x + width, free.y, leftoverWidth, height};
+            bottom = {free.x, free.y + height, free.width, leftoverHeight};
+        } else {
+            right = {free.x + width, free.y, leftoverWidth, free.height};
+            bottom = {free.x, free.y + height, width, leftoverHeight};
+        }
+
+        if (right.width > 0 && right.height > 0) freeRegions.push_back(right);
+        if (bottom.width > 0 && bottom.height > 0) freeRegions.push_back(bottom);
+
+        return {free.x, free.y, width, height};
+    }
+
+    static bool tryMerge(Region& a, Region const& b) {
+        if (a.y == b.y && a.height == b.height) {
+            if (a.x + a.width == b.x) {
+                a.width += b.width;
+                return true;
+            }
+            if (b.x + b.width == a.x) {
+                a.x = b.x;
+                a.width += b.width;
+                return true;
+            }
+        }
+
+        if (a.x == b.x && a.width == b.width) {
+            if (a.y + a.height == b.y) {
+                a.height += b.height;
+                return true;
+            }
+            if (b.y + b.height == a.y) {
+                a.y = b.y;
+                a.height += b.height;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // joins free regions that share a whole edge, so space of removed images can fit bigger ones again
+    static void mergeFreeRegions(std::vector<Region>& freeRegions) {
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (size_t i = 0; i < freeRegions.size() && !merged; ++i) {
+                for (size_t j = i + 1; j < freeRegions.size(); ++j) {
+                    if (tryMerge(freeRegions[i], freeRegions[j])) {
+                        freeRegions[j] = freeRegions.back();
+                        freeRegions.pop_back();
+                        merged = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // RGBA copy of the image with its edge pixels stretched into the padding.
+    // pages are premultiplied like textures from CCTextureCache, so straight sources are converted
+    static std::vector<uint8_t> makePaddedPixels(cocos2d::CCImage* image, unsigned padding) {
+        int width = image->getWidth();
+        int height = image->getHeight();
+        size_t channels = image->hasAlpha() ? 4 : 3;
+        bool straight = image->hasAlpha() && !image->isPremultipliedAlpha();
+        auto data = image->getData();
+
+        int paddedWidth = width + static_cast<int>(padding) * 2;
+        int paddedHeight = height + static_cast<int>(padding) * 2;
+        std::vector<uint8_t> pixels(static_cast<size_t>(paddedWidth) * paddedHeight * 4);
+
+        auto out = pixels.data();
+        for (int y = 0; y < paddedHeight; ++y) {
+            auto sourceY = std::clamp(y - static_cast<int>(padding), 0, height - 1);
+            for (int x = 0; x < paddedWidth; ++x) {
+                auto sourceX = std::clamp(x - static_cast<int>(padding), 0, width - 1);
+                auto in = data + (static_cast<size_t>(sourceY) * width + sourceX) * channels;
+
+                uint8_t alpha = channels == 4 ? in[3] : 255;
+                for (size_t c = 0; c < 3; ++c) {
+                    out[c] = straight ? static_cast<uint8_t>((in[c] * alpha + 127) / 255) : in[c];
+                }
+                out[3] = alpha;
+                out += 4;
+            }
+        }
+
+        return pixels;
+    }
+
+    static bool initPageTexture(cocos2d::CCTexture2D* texture, void const* pixels, unsigned pageSize) {
+        auto size = cocos2d::CCSize(static_cast<float>(pageSize), static_cast<float>(pageSize));
+        if (!texture->initWithData(pixels, cocos2d::kCCTexture2DPixelFormat_RGBA8888, pageSize, pageSize, size)) {
+            return false;
+        }
+
+        // initWithData always assumes straight alpha. sprites pick GL_ONE as the source factor from this,
+        // which is what the RoundedSprite shader expects
+        texture->m_bHasPremultipliedAlpha = true;
+        return true;
+    }
+
+    TextureAtlas::~TextureAtlas() {
+        this->clear();
+
+#ifdef GEODE_IS_ANDROID
+        cocos2d::CCNotificationCenter::sharedNotificationCenter()->removeObserver(this, EVENT_COME_TO_FOREGROUND);
+#endif
+    }
+
+    TextureAtlas* TextureAtlas::create(unsigned pageSize, unsigned padding) {
+        auto ret = new TextureAtlas();
+        if (ret->init(pageSize, padding)) {
+            ret->autorelease();
+            return ret;
+        }
+        delete ret;
+        return nullptr;
+    }
+
+    bool TextureAtlas::init(unsigned pageSize, unsigned padding) {
+        if (pageSize == 0 || padding * 2 >= pageSize) {
+            geode::log::error("Invalid atlas page size {} with padding {}", pageSize, padding);
+            return false;
+        }
+
+        m_pageSize = pageSize;
+        m_padding = padding;
+        m_contextEpoch = util::getContextEpoch();
+
+#ifdef GEODE_IS_ANDROID
+        // observers are notified in order, so the epoch is already bumped when ours runs
+        util::watchContextLoss();
+        cocos2d::CCNotificationCenter::sharedNotificationCenter()->addObserver(
+            this,
+            callfuncO_selector(TextureAtlas::onContextRecreated),
+            EVENT_COME_TO_FOREGROUND,
+            nullptr
+        );
+#endif
+
+        return true;
+    }
+
+    cocos2d::CCSpriteFrame* TextureAtlas::addImage(std::string const& key, cocos2d::CCImage* image) {
+        if (auto frame = this->getFrame(key)) {
+            return frame;
+        }
+
+        if (!image || !image->getData() || image->getBitsPerComponent() != 8) {
+            geode::log::error("Unsupported image for atlas: {}", key);
+            return nullptr;
+        }
+
+        unsigned width = image->getWidth();
+        unsigned height = image->getHeight();
+        auto paddedWidth = width + m_padding * 2;
+        auto paddedHeight = height + m_padding * 2;
+        if (width == 0 || height == 0 || paddedWidth > m_pageSize || paddedHeight > m_pageSize) {
+            geode::log::error("Image {} ({}x{}) doesn't fit into an atlas page", key, width, height);
+            return nullptr;
+        }
+
+        // earlier pages are filled first, so images added together tend to share a texture
+        Page* page = nullptr;
+        size_t index = 0;
+        for (auto& candidate : m_pages) {
+            if (findFreeRegion(candidate->freeRegions, paddedWidth, paddedHeight, index)) {
+                page = candidate.get();
+                break;
+            }
+        }
+
+        if (!page) {
+            if (m_pages.size() >= m_maxPages) {
+                geode::log::error("Atlas is full, can't add {}", key);
+                return nullptr;
+            }
+
+            page = this->addPage();
+            if (!page) return nullptr;
+            index = 0;
+        }
+
+        auto region = takeFreeRegion(page->freeRegions, index, paddedWidth, paddedHeight);
+        this->uploadRegion(*page, region, makePaddedPixels(image, m_padding));
+
+        auto frame = cocos2d::CCSpriteFrame::createWithTexture(
+            page->texture,
+            CC_RECT_PIXELS_TO_POINTS(cocos2d::CCRect(
+                static_cast<float>(region.x + m_padding),
+                static_cast<float>(region.y + m_padding),
+                static_cast<float>(width),
+                static_cast<float>(height)
+            ))
+        );
+        frame->retain();
+
+        page->imageCount++;
+        page->usedArea += static_cast<size_t>(region.width) * region.height;
+        m_entries.emplace(key, Entry{page, region, frame});
+        return frame;
+    }
+
+    cocos2d::CCSpriteFrame* TextureAtlas::addFile(char const* filename) {
+        if (auto frame = this->getFrame(filename)) {
+            return frame;
+        }
+
+        std::string path = cocos2d::CCFileUtils::sharedFileUtils()->fullPathForFilename(filename, false);
+        auto image = new cocos2d::CCImage();
+        if (!image->initWithImageFile(path.c_str(), util::getImageFormat(path))) {
+            geode::log::error("Failed to load image {}", path);
+            image->release();
+            return nullptr;
+        }
+
+        auto frame = this->addImage(filename, image);
+        image->release();
+        return frame;
+    }
+
+    void TextureAtlas::addFileAsync(char const* filename, std::function<void(cocos2d::CCSpriteFrame*)> callback) {
+        if (auto frame = this->getFrame(filename)) {
+            if (callback) callback(frame);
+            return;
+        }
+
+        // same split as RoundedSprite::createAsync: resolve the path here, decode on a worker,
+        // and touch the atlas only on the main thread
+        std::string key = filename;
+        std::string path = cocos2d::CCFileUtils::sharedFileUtils()->fullPathForFilename(filename, false);
+        this->retain();
+        ThreadPool::get()->submit([this, key, path, callback = std::move(callback)] {
+            auto image = new cocos2d::CCImage();
+            if (!image->initWithImageFileThreadSafe(path.c_str(), util::getImageFormat(path))) {
+                image->release();
+                image = nullptr;
+            }
+
+            geode::queueInMainThread([this, key, path, image, callback] {
+                cocos2d::CCSpriteFrame* frame = nullptr;
+                if (image) {
+                    frame = this->addImage(key, image);
+                    image->release();
+                } else {
+                    geode::log::error("Failed to load image {}", path);
+                }
+
+                if (callback) callback(frame);
+                this->release();
+            });
+        });
+    }
+
+    cocos2d::CCSpriteFrame* TextureAtlas::getFrame(std::string_view key) const {
+        auto it = m_entries.find(key);
+        return it != m_entries.end() ? it->second.frame : nullptr;
+    }
+
+    bool TextureAtlas::remove(std::string_view key) {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end()) return false;
+
+        auto& entry = it->second;
+        auto page = entry.page;
+        page->freeRegions.push_back(entry.region);
+        mergeFreeRegions(page->freeRegions);
+        page->imageCount--;
+        page->usedArea -= static_cast<size_t>(entry.region.width) * entry.region.height;
+
+        entry.frame->release();
+        m_entries.erase(it);
+
+        if (page->imageCount == 0) {
+            this->removePage(page);
+        }
+
+        return true;
+    }
+
+    void TextureAtlas::clear() {
+        for (auto& [key, entry] : m_entries) {
+            entry.frame->release();
+        }
+        m_entries.clear();
+
+        // sprites retain their texture, so pages they still use stay alive until they're gone
+        for (auto& page : m_pages) {
+            page->texture->release();
+        }
+        m_pages.clear();
+    }
+
+    void TextureAtlas::setMaxPages(size_t pages) {
+        m_maxPages = pages;
+    }
+
+    size_t TextureAtlas::getMaxPages() const {
+        return m_maxPages;
+    }
+
+    size_t TextureAtlas::getPageCount() const {
+        return m_pages.size();
+    }
+
+    size_t TextureAtlas::getImageCount() const {
+        return m_entries.size();
+    }
+
+    float TextureAtlas::getOccupancy() const {
+        if (m_pages.empty()) return 0.f;
+
+        size_t used = 0;
+        for (auto& page : m_pages) {
+            used += page->usedArea;
+        }
+
+        auto total = static_cast<size_t>(m_pageSize) * m_pageSize * m_pages.size();
+        return static_cast<float>(used) / static_cast<float>(total);
+    }
+
+    TextureAtlas::Page* TextureAtlas::addPage() {
+        // cleared pixels keep unused parts of the page transparent
+        std::vector<uint8_t> pixels(static_cast<size_t>(m_pageSize) * m_pageSize * 4, 0);
+
+        auto texture = new cocos2d::CCTexture2D();
+        if (!initPageTexture(texture, pixels.data(), m_pageSize)) {
+            geode::log::error("Failed to create atlas page");
+            texture->release();
+            return nullptr;
+        }
+
+        auto page = std::make_unique<Page>();
+        page->texture = texture;
+        page->freeRegions.push_back({0, 0, m_pageSize, m_pageSize});
+#ifdef GEODE_IS_ANDROID
+        page->pixels = std::move(pixels);
+#endif
+
+        return m_pages.emplace_back(std::move(page)).get();
+    }
+
+    void TextureAtlas::removePage(Page* page) {
+        auto it = std::ranges::find_if(m_pages, [page](auto const& candidate) { return candidate.get() == page; });
+        if (it == m_pages.end()) return;
+
+        page->texture->release();
+        m_pages.erase(it);
+    }
+
+    void TextureAtlas::uploadRegion(Page& page, Region const& region, std::vector<uint8_t> const& pixels) {
+        // queued quads might still sample a region that's being reused
+        RenderQueue::get()->flush();
+
+        // RGBA rows are always 4-byte aligned, so the default unpack alignment works
+        cocos2d::ccGLBindTexture2D(page.texture->getName());
+        glTexSubImage2D(
+            GL_TEXTURE_2D, 0,
+            static_cast<GLint>(region.x), static_cast<GLint>(region.y),
+            static_cast<GLsizei>(region.width), static_cast<GLsizei>(region.height),
+            GL_RGBA, GL_UNSIGNED_BYTE,
+            pixels.data()
+        );
+
+#ifdef GEODE_IS_ANDROID
+        for (unsigned row = 0; row < region.height; ++row) {
+            std::memcpy(
+                page.pixels.data() + (static_cast<size_t>(region.y + row) * m_pageSize + region.x) * 4,
+                pixels.data() + static_cast<size_t>(row) * region.width * 4,
+                static_cast<size_t>(region.width) * 4
+            );
+        }
+#endif
+    }
+
+    void TextureAtlas::onContextRecreated(cocos2d::CCObject*) {
+        // the event can come without the context actually being lost,
+        // and initWithData on live textures would leak their names
+        if (m_contextEpoch == util::getContextEpoch()) return;
+        m_contextEpoch = util::getContextEpoch();
+
+        // the old texture names died together with the context, so there's nothing to delete.
+        // initWithData generates a new name in place, sprites keep pointing at the same CCTexture2D
+        for (auto& page : m_pages) {
+            initPageTexture(page->texture, page->pixels.data(), m_pageSize);
+        }
+    }
+} // namespace rock
@@ -0,0 +1,188 @@
+#include <rock/ThreadPool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace rock {
+    /// @brief Range of chunks owned by a single thread, packed as (end << 32 | begin) so it can be
+    /// shrunk from the front by its owner and from the back by thieves with a single CAS
+    struct alignas(64) ChunkRange {
+        std::atomic<uint64_t> value{0};
+    };
+
+    /// @brief State of a parallelFor, shared with helper tasks that might start after it has returned
+    struct ParallelJob {
+        std::function<void(size_t, size_t)> const* func = nullptr;
+        size_t count = 0;
+        size_t grainSize = 0;
+        size_t participants = 0;
+        std::unique_ptr<ChunkRange[]> ranges;
+        std::atomic<size_t> nextParticipant{1};
+        std::atomic<size_t> remaining{0};
+    };
+
+    static uint64_t packRange(uint32_t begin, uint32_t end) {
+        return static_cast<uint64_t>(end) << 32 | begin;
+    }
+
+    static bool popChunk(ChunkRange& range, uint32_t& chunk) {
+        auto value = range.value.load(std::memory_order_acquire);
+        while (true) {
+            auto begin = static_cast<uint32_t>(value);
+            auto end = static_cast<uint32_t>(value >> 32);
+            if (begin >= end) return false;
+
+            if (range.value.compare_exchange_weak(value, packRange(begin + 1, end), std::memory_order_acq_rel)) {
+                chunk = begin;
+                return true;
+            }
+        }
+    }
+
+    static bool stealChunks(ChunkRange& victim, uint32_t& begin, uint32_t& end) {
+        auto value = victim.value.load(std::memory_order_acquire);
+        while (true) {
+            auto victimBegin = static_cast<uint32_t>(value);
+            auto victimEnd = static_cast<uint32_t>(value >> 32);
+            if (victimBegin >= victimEnd) return false;
+
+            // take the back half, the owner keeps working from the front
+            auto middle = victimBegin + (victimEnd - victimBegin) / 2;
+            if (victim.value.compare_exchange_weak(value, packRange(victimBegin, middle), std::memory_order_acq_rel)) {
+                begin = middle;
+                end = victimEnd;
+                return true;
+            }
+        }
+    }
+
+    static void runParticipant(ParallelJob& job, size_t self) {
+        auto& own = job.ranges[self];
+        while (true) {
+            uint32_t chunk;
+            while (popChunk(own, chunk)) {
+                auto begin = static_cast<size_t>(chunk) * job.grainSize;
+                auto end = std::min(job.count, begin + job.grainSize);
+                (*job.func)(begin, end);
+                job.remaining.fetch_sub(1, std::memory_order_acq_rel);
+            }
+
+            // own range is empty, so nobody else can be stealing from it while it's refilled
+            bool stolen = false;
+            for (size_t i = 1; i < job.participants && !stolen; ++i) {
+                uint32_t begin, end;
+                if (stealChunks(job.ranges[(self + i) % job.participants], begin, end)) {
+                    own.value.store(packRange(begin, end), std::memory_order_release);
+                    stolen = true;
+                }
+            }
+
+            if (!stolen) return;
+        }
+    }
+
+    ThreadPool::ThreadPool(size_t threads) {
+        threads = std::max<size_t>(threads, 1);
+        m_threads.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            m_threads.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    ThreadPool* ThreadPool::get() {
+        // intentionally leaked: joining threads during static destruction
+        // can deadlock when the game unloads the mod
+        static auto instance = new ThreadPool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+        return instance;
+    }
+
+    void ThreadPool::submit(std::function<void()> task) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_condition.notify_one();
+    }
+
+    void ThreadPool::parallelFor(
+        size_t count,
+        size_t grainSize,
+        std::function<void(size_t begin, size_t end)> const& func,
+        size_t maxThreads
+    ) {
+        if (count == 0) return;
+
+        grainSize = std::max<size_t>(grainSize, 1);
+        auto chunks = (count + grainSize - 1) / grainSize;
+
+        auto participants = m_threads.size() + 1;
+        if (maxThreads > 0) participants = std::min(participants, maxThreads);
+        participants = std::min(participants, chunks);
+
+        if (participants <= 1) {
+            func(0, count);
+            return;
+        }
+
+        auto job = std::make_shared<ParallelJob>();
+        job->func = &func;
+        job->count = count;
+        job->grainSize = grainSize;
+        job->participants = participants;
+        job->ranges = std::make_unique<ChunkRange[]>(participants);
+        job->remaining.store(chunks, std::memory_order_relaxed);
+
+        for (size_t i = 0; i < participants; ++i) {
+            job->ranges[i].value.store(packRange(
+                static_cast<uint32_t>(chunks * i / participants),
+                static_cast<uint32_t>(chunks * (i + 1) / participants)
+            ), std::memory_order_relaxed);
+        }
+
+        // helpers that only get to run after everything is done find empty ranges and leave
+        for (size_t i = 1; i < participants; ++i) {
+            this->submit([job] {
+                runParticipant(*job, job->nextParticipant.fetch_add(1, std::memory_order_relaxed));
+            });
+        }
+
+        runParticipant(*job, 0);
+
+        // the rest of the chunks were stolen and are still running on other threads
+        while (job->remaining.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    size_t ThreadPool::getThreadCount() const {
+        return m_threads.size();
+    }
+
+    void ThreadPool::workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_stopping && m_tasks.empty()) return;
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+} // namespace rock
@@ -4,15 +4,56 @@
 #include <Geode/loader/Log.hpp>
 #include <Geode/utils/general.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <string_view>
+#include <unordered_map>
+
 namespace rock::util {
-    static geode::Result<GLuint> compileShader(GLenum type, char const* src) {
+    /// @brief Everything needed to rebuild a program after the GL context is recreated
+    struct ProgramEntry {
+        cocos2d::CCGLProgram* program = nullptr;
+        std::string vertShader;
+        std::string fragShader;
+        std::string defines;
+        unsigned epoch = 0;
+        // false for programs adopted from another mod's registry, which relinks them itself
+        bool owned = true;
+    };
+
+    struct ProgramNameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+
+    /// @brief Listens for the notification android posts after recreating the GL context
+    class ContextObserver : public cocos2d::CCObject {
+    public:
+        void onContextRecreated(cocos2d::CCObject*) {
+            notifyContextLost();
+        }
+    };
+
+    static std::unordered_map<std::string, ProgramEntry, ProgramNameHash, std::equal_to<>> s_programs;
+    static unsigned s_contextEpoch = 0;
+    static cocos2d::CCSize s_viewportSize;
+    static bool s_viewportValid = false;
+
+    static geode::Result<GLuint> compileShader(GLenum type, char const* defines, char const* src) {
         GLuint shader = glCreateShader(type);
 
         GLchar const* sources[] = {
+            defines,
     #ifdef GEODE_IS_MOBILE
             (type == GL_VERTEX_SHADER
                 ? "precision highp float;\n"
-                : "#extension GL_OES_standard_derivatives : enable\n"
+                // analytic anti-aliasing doesn't need fwidth, so it works without the extension
+                : "#ifndef ROCK_ANALYTIC_AA\n"
+                  "#extension GL_OES_standard_derivatives : enable\n"
+                  "#endif\n"
                   "precision mediump float;\n"),
     #endif
             "uniform mat4 CC_PMatrix;\n"
@@ -55,9 +96,13 @@ namespace rock::util {
         return geode::Ok(shader);
     }
 
-    static geode::Result<GLuint> createShaderProgram(char const* vertShader, char const* fragShader) {
-        GEODE_UNWRAP_INTO(auto vert, compileShader(GL_VERTEX_SHADER, vertShader));
-        GEODE_UNWRAP_INTO(auto frag, compileShader(GL_FRAGMENT_SHADER, fragShader));
+    static geode::Result<GLuint> createShaderProgram(
+        char const* vertShader,
+        char const* fragShader,
+        char const* defines
+    ) {
+        GEODE_UNWRAP_INTO(auto vert, compileShader(GL_VERTEX_SHADER, defines, vertShader));
+        GEODE_UNWRAP_INTO(auto frag, compileShader(GL_FRAGMENT_SHADER, defines, fragShader));
 
         GLuint program = glCreateProgram();
         glAttachShader(program, vert);
@@ -66,7 +111,10 @@ namespace rock::util {
         glBindAttribLocation(program, cocos2d::kCCVertexAttrib_Position, "a_position");
         glBindAttribLocation(program, cocos2d::kCCVertexAttrib_Color, "a_color");
         glBindAttribLocation(program, cocos2d::kCCVertexAttrib_TexCoords, "a_texCoord");
-        glBindAttribLocation(program, 3, "a_texCoord2");
+        glBindAttribLocation(program, VERTEX_ATTRIB_LOCAL_UV, "a_texCoord2");
+        glBindAttribLocation(program, VERTEX_ATTRIB_RADII, "a_radii");
+        glBindAttribLocation(program, VERTEX_ATTRIB_SIZE, "a_size");
+        glBindAttribLocation(program, VERTEX_ATTRIB_PIXEL_SCALE, "a_pixelScale");
 
         glLinkProgram(program);
 
@@ -93,18 +141,147 @@ namespace rock::util {
         return geode::Ok(program);
     }
 
+    void watchContextLoss() {
+        // only android recreates the context, other platforms post the same event on a plain resume
+#ifdef GEODE_IS_ANDROID
+        static bool watching = false;
+        if (watching) return;
+        watching = true;
+
+        // notification center doesn't retain observers, so this lives for the whole session
+        auto observer = new ContextObserver();
+        cocos2d::CCNotificationCenter::sharedNotificationCenter()->addObserver(
+            observer,
+            callfuncO_selector(ContextObserver::onContextRecreated),
+            EVENT_COME_TO_FOREGROUND,
+            nullptr
+        );
+#endif
+    }
+
+    static bool relinkProgram(ProgramEntry& entry) {
+        auto result = createShaderProgram(
+            entry.vertShader.c_str(),
+            entry.fragShader.c_str(),
+            entry.defines.c_str()
+        );
+
+        if (result.isErr()) {
+            geode::log::error("{}", result.unwrapErr());
+            return false;
+        }
+
+        // the old handle died together with the context, so there's nothing to delete.
+        // reset() also drops cached uniform values, which the new program doesn't have yet
+        entry.program->reset();
+        entry.program->m_uProgram = result.unwrap();
+        entry.program->updateUniforms();
+        entry.epoch = s_contextEpoch;
+
+        return true;
+    }
+
+    unsigned getContextEpoch() {
+        return s_contextEpoch;
+    }
+
+    void notifyContextLost() {
+        s_contextEpoch++;
+    }
+
+    float getPixelScale(
+        kmMat4 const& modelview,
+        kmMat4 const& projection,
+        float viewportWidth,
+        float viewportHeight
+    ) {
+        kmMat4 mvp;
+        kmMat4Multiply(&mvp, &projection, &modelview);
+
+        // a flat node has the same w everywhere, so the origin's one applies to the whole node
+        float w = std::abs(mvp.mat[15]);
+        if (w == 0.f) return 0.f;
+
+        // clip space spans 2 units across the viewport
+        float pixelsX = viewportWidth * 0.5f / w;
+        float pixelsY = viewportHeight * 0.5f / w;
+
+        // area scale of the 2D part of the transform, so non-uniform scaling averages out
+        float det = (mvp.mat[0] * mvp.mat[5] - mvp.mat[1] * mvp.mat[4]) * pixelsX * pixelsY;
+        return std::sqrt(std::abs(det));
+    }
+
+    cocos2d::CCSize getViewportSize() {
+        if (!s_viewportValid) {
+            GLint viewport[4];
+            glGetIntegerv(GL_VIEWPORT, viewport);
+            s_viewportSize = {static_cast<float>(viewport[2]), static_cast<float>(viewport[3])};
+            s_viewportValid = true;
+        }
+        return s_viewportSize;
+    }
+
+    void invalidateViewport() {
+        s_viewportValid = false;
+    }
+
+    float getPixelScale() {
+        kmMat4 mv, projection;
+        kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
+        kmGLGetMatrix(KM_GL_PROJECTION, &projection);
+
+        // render textures set their own viewport, so the GL view scale only applies on screen
+        auto viewport = getViewportSize();
+        return getPixelScale(mv, projection, viewport.width, viewport.height);
+    }
+
+    cocos2d::CCImage::EImageFormat getImageFormat(std::string const& path) {
+        auto dot = path.find_last_of('.');
+        if (dot == std::string::npos) {
+            return cocos2d::CCImage::kFmtUnKnown;
+        }
+
+        auto ext = path.substr(dot + 1);
+        std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (ext == "png") return cocos2d::CCImage::kFmtPng;
+        if (ext == "jpg" || ext == "jpeg") return cocos2d::CCImage::kFmtJpg;
+        if (ext == "tif" || ext == "tiff") return cocos2d::CCImage::kFmtTiff;
+        if (ext == "webp") return cocos2d::CCImage::kFmtWebp;
+        return cocos2d::CCImage::kFmtUnKnown;
+    }
+
     cocos2d::CCGLProgram* getShaderProgram(
         char const* name,
         char const* vertShader,
-        char const* fragShader
+        char const* fragShader,
+        char const* defines
     ) {
+        if (auto it = s_programs.find(std::string_view(name)); it != s_programs.end()) {
+            auto& entry = it->second;
+            if (entry.epoch != s_contextEpoch) {
+                // adopted programs are relinked in place by the mod that created them,
+                // linking them here too would leak one of the two new handles
+                if (!entry.owned) {
+                    entry.epoch = s_contextEpoch;
+                } else if (!relinkProgram(entry)) {
+                    return nullptr;
+                }
+            }
+            return entry.program;
+        }
+
+        watchContextLoss();
+
+        // program could've been added by another mod using rock
         auto cache = cocos2d::CCShaderCache::sharedShaderCache();
         auto program = cache->programForKey(name);
         if (program) {
+            program->retain();
+            s_programs.emplace(name, ProgramEntry{program, vertShader, fragShader, defines, s_contextEpoch, false});
             return program;
         }
 
-        auto result = createShaderProgram(vertShader, fragShader);
+        auto result = createShaderProgram(vertShader, fragShader, defines);
         if (result.isErr()) {
             geode::log::error("{}", result.unwrapErr());
             return nullptr;
@@ -119,7 +296,9 @@ namespace rock::util {
 
         program->updateUniforms();
         cache->addProgram(program, name);
-        program->release();
+
+        // registry keeps the reference from `new`, so the program outlives cache purges
+        s_programs.emplace(name, ProgramEntry{program, vertShader, fragShader, defines, s_contextEpoch});
 
         return program;
     }
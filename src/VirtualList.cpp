@@ -0,0 +1,390 @@
+#include <rock/VirtualList.hpp>
+#include <rock/RenderQueue.hpp>
+
+#include <Geode/loader/Log.hpp>
+#include <Geode/utils/cocos.hpp>
+
+#include <cmath>
+
+namespace rock {
+    // rows always take up some space, so offsets can be divided by the row height
+    static constexpr float s_minRowHeight = 1.f;
+
+    static float sanitizeRowHeight(float height) {
+        if (std::isfinite(height) && height >= s_minRowHeight) return height;
+
+        geode::log::warn("Invalid row height {}, using {} instead", height, s_minRowHeight);
+        return s_minRowHeight;
+    }
+
+    VirtualList::~VirtualList() = default;
+
+    VirtualList* VirtualList::create(
+        cocos2d::CCSize const& size,
+        RowFactory factory,
+        RowBinder binder
+    ) {
+        auto ret = new VirtualList();
+        if (ret->init(size, std::move(factory), std::move(binder))) {
+            ret->autorelease();
+            return ret;
+        }
+        delete ret;
+        return nullptr;
+    }
+
+    bool VirtualList::init(
+        cocos2d::CCSize const& size,
+        RowFactory factory,
+        RowBinder binder
+    ) {
+        if (!CCLayer::init()) {
+            return false;
+        }
+
+        m_factory = std::move(factory);
+        m_binder = std::move(binder);
+
+        m_content = cocos2d::CCNode::create();
+        this->addChild(m_content);
+
+        this->setContentSize(size);
+        this->setTouchEnabled(true);
+        this->setMouseEnabled(true);
+        this->scheduleUpdate();
+
+        return true;
+    }
+
+    void VirtualList::setRowCount(size_t count) {
+        m_rowCount = count;
+        this->reloadData();
+    }
+
+    size_t VirtualList::getRowCount() const {
+        return m_rowCount;
+    }
+
+    void VirtualList::setRowHeight(float height) {
+        m_rowHeightCallback = nullptr;
+        m_rowHeight = sanitizeRowHeight(height);
+        this->reloadData();
+    }
+
+    void VirtualList::setRowHeight(RowHeight callback, float estimatedHeight) {
+        m_rowHeightCallback = std::move(callback);
+        m_rowHeight = sanitizeRowHeight(estimatedHeight);
+        this->reloadData();
+    }
+
+    void VirtualList::setOverscan(float margin) {
+        m_overscan = margin;
+        this->updateVisibleRows();
+    }
+
+    void VirtualList::reloadData() {
+        for (auto row : m_activeRows) {
+            this->recycleRow(row);
+        }
+        m_activeRows.clear();
+        m_rowTops.clear();
+
+        this->setScrollOffset(m_scrollOffset);
+    }
+
+    void VirtualList::invalidateRow(size_t index) {
+        if (index >= m_rowCount) return;
+
+        // everything below the changed row has to be measured again
+        if (m_rowHeightCallback && m_rowTops.size() > index + 1) {
+            m_rowTops.resize(index + 1);
+        }
+
+        for (size_t i = 0; i < m_activeRows.size(); ++i) {
+            auto rowIndex = m_firstActive + i;
+            if (rowIndex == index) {
+                m_binder(m_activeRows[i], rowIndex);
+            }
+            if (rowIndex >= index) {
+                this->placeRow(m_activeRows[i], rowIndex);
+            }
+        }
+
+        this->setScrollOffset(m_scrollOffset);
+    }
+
+    void VirtualList::setScrollOffset(float offset) {
+        m_scrollOffset = std::clamp(offset, 0.f, this->getMaxScrollOffset());
+        m_content->setPosition({0.f, m_obContentSize.height + m_scrollOffset});
+        this->updateVisibleRows();
+    }
+
+    float VirtualList::getScrollOffset() const {
+        return m_scrollOffset;
+    }
+
+    float VirtualList::getMaxScrollOffset() const {
+        return std::max(0.f, this->getContentHeight() - m_obContentSize.height);
+    }
+
+    void VirtualList::scrollToRow(size_t index) {
+        if (index >= m_rowCount) return;
+        m_velocity = 0.f;
+        this->setScrollOffset(this->getRowTop(index));
+    }
+
+    size_t VirtualList::getActiveRowCount() const {
+        return m_activeRows.size();
+    }
+
+    size_t VirtualList::getPooledRowCount() const {
+        return m_pool.size();
+    }
+
+    float VirtualList::getRowTop(size_t index) {
+        if (!m_rowHeightCallback) {
+            return index * m_rowHeight;
+        }
+
+        while (m_rowTops.size() <= index && m_rowTops.size() <= m_rowCount) {
+            auto next = m_rowTops.size();
+            m_rowTops.push_back(next == 0 ? 0.f : m_rowTops.back() + this->measureRow(next - 1));
+        }
+        return m_rowTops[index];
+    }
+
+    float VirtualList::measureRow(size_t index) {
+        // negative or NaN heights would leave m_rowTops unsorted, breaking the binary search in getRowAt
+        auto height = m_rowHeightCallback(index);
+        return std::isfinite(height) && height > 0.f ? height : 0.f;
+    }
+
+    float VirtualList::getRowHeight(size_t index) {
+        if (!m_rowHeightCallback) {
+            return m_rowHeight;
+        }
+
+        return this->getRowTop(index + 1) - this->getRowTop(index);
+    }
+
+    void VirtualList::measureUntil(float offset) {
+        if (!m_rowHeightCallback) return;
+
+        if (m_rowTops.empty()) {
+            m_rowTops.push_back(0.f);
+        }
+
+        while (m_rowTops.back() < offset && m_rowTops.size() <= m_rowCount) {
+            auto next = m_rowTops.size();
+            m_rowTops.push_back(m_rowTops.back() + this->measureRow(next - 1));
+        }
+    }
+
+    size_t VirtualList::getRowAt(float offset) {
+        if (m_rowCount == 0) return 0;
+
+        if (!m_rowHeightCallback) {
+            // compare before casting, offsets past the last row don't fit into size_t
+            auto row = offset / m_rowHeight;
+            if (!(row > 0.f)) return 0;
+            if (row >= static_cast<float>(m_rowCount - 1)) return m_rowCount - 1;
+            return static_cast<size_t>(row);
+        }
+
+        this->measureUntil(offset);
+        auto it = std::upper_bound(m_rowTops.begin(), m_rowTops.end(), offset);
+        auto index = static_cast<size_t>(std::max<ptrdiff_t>(0, it - m_rowTops.begin() - 1));
+        return std::min(index, m_rowCount - 1);
+    }
+
+    float VirtualList::getContentHeight() const {
+        if (!m_rowHeightCallback || m_rowTops.empty()) {
+            return m_rowCount * m_rowHeight;
+        }
+
+        // rows that weren't measured yet use the estimated height
+        auto measured = m_rowTops.size() - 1;
+        return m_rowTops.back() + (m_rowCount - measured) * m_rowHeight;
+    }
+
+    cocos2d::CCNode* VirtualList::obtainRow(size_t index) {
+        cocos2d::CCNode* row;
+        if (!m_pool.empty()) {
+            row = m_pool.back();
+            m_pool.pop_back();
+            row->setVisible(true);
+        } else {
+            row = m_factory();
+            if (!row) {
+                // keep indices consistent even if the factory fails
+                row = cocos2d::CCNode::create();
+            }
+            m_content->addChild(row);
+        }
+
+        m_binder(row, index);
+        this->placeRow(row, index);
+        return row;
+    }
+
+    void VirtualList::recycleRow(cocos2d::CCNode* row) {
+        // pooled rows stay in the tree, so they're kept alive without add/remove churn
+        row->setVisible(false);
+        m_pool.push_back(row);
+    }
+
+    void VirtualList::placeRow(cocos2d::CCNode* row, size_t index) {
+        auto bottom = -(this->getRowTop(index) + this->getRowHeight(index));
+        auto anchor = row->isIgnoreAnchorPointForPosition()
+            ? cocos2d::CCPoint{0.f, 0.f}
+            : row->getAnchorPoint();
+        auto size = row->getContentSize();
+
+        row->setPosition({
+            anchor.x * size.width * row->getScaleX(),
+            bottom + anchor.y * size.height * row->getScaleY()
+        });
+    }
+
+    void VirtualList::updateVisibleRows() {
+        if (!m_content) return;
+
+        size_t first = 0;
+        size_t last = 0;
+        if (m_rowCount > 0) {
+            auto top = std::max(0.f, m_scrollOffset - m_overscan);
+            auto bottom = m_scrollOffset + m_obContentSize.height + m_overscan;
+            first = this->getRowAt(top);
+            last = std::min(m_rowCount, this->getRowAt(bottom) + 1);
+        }
+
+        // recycle rows that went out of range
+        while (!m_activeRows.empty() && m_firstActive < first) {
+            this->recycleRow(m_activeRows.front());
+            m_activeRows.pop_front();
+            ++m_firstActive;
+        }
+        while (!m_activeRows.empty() && m_firstActive + m_activeRows.size() > last) {
+            this->recycleRow(m_activeRows.back());
+            m_activeRows.pop_back();
+        }
+
+        if (m_activeRows.empty()) {
+            m_firstActive = first;
+        }
+
+        // bind rows that came into range
+        while (m_firstActive > first) {
+            --m_firstActive;
+            m_activeRows.push_front(this->obtainRow(m_firstActive));
+        }
+        while (m_firstActive + m_activeRows.size() < last) {
+            m_activeRows.push_back(this->obtainRow(m_firstActive + m_activeRows.size()));
+        }
+    }
+
+    void VirtualList::visit() {
+        if (!m_bVisible) return;
+
+        auto view = cocos2d::CCEGLView::sharedOpenGLView();
+        auto bottomLeft = this->convertToWorldSpace({0.f, 0.f});
+        auto topRight = this->convertToWorldSpace({m_obContentSize.width, m_obContentSize.height});
+
+        auto minX = std::min(bottomLeft.x, topRight.x);
+        auto minY = std::min(bottomLeft.y, topRight.y);
+        auto maxX = std::max(bottomLeft.x, topRight.x);
+        auto maxY = std::max(bottomLeft.y, topRight.y);
+
+        // respect scissor of a parent list
+        auto parentScissor = view->isScissorEnabled();
+        cocos2d::CCRect parentRect;
+        if (parentScissor) {
+            parentRect = view->getScissorRect();
+            minX = std::max(minX, parentRect.getMinX());
+            minY = std::max(minY, parentRect.getMinY());
+            maxX = std::min(maxX, parentRect.getMaxX());
+            maxY = std::min(maxY, parentRect.getMaxY());
+        }
+
+        // queued quads from outside must not be clipped, and ours must be clipped
+        RenderQueue::get()->flush();
+        glEnable(GL_SCISSOR_TEST);
+        view->setScissorInPoints(minX, minY, std::max(0.f, maxX - minX), std::max(0.f, maxY - minY));
+
+        CCLayer::visit();
+
+        RenderQueue::get()->flush();
+        if (parentScissor) {
+            view->setScissorInPoints(
+                parentRect.origin.x, parentRect.origin.y,
+                parentRect.size.width, parentRect.size.height
+            );
+        } else {
+            glDisable(GL_SCISSOR_TEST);
+        }
+    }
+
+    void VirtualList::update(float dt) {
+        if (m_touching || m_velocity == 0.f) return;
+
+        auto previous = m_scrollOffset;
+        this->setScrollOffset(m_scrollOffset + m_velocity * dt);
+
+        // stop when friction slows us down enough, or we hit either end of the list
+        m_velocity *= std::pow(0.05f, dt);
+        if (std::abs(m_velocity) < 5.f || m_scrollOffset == previous) {
+            m_velocity = 0.f;
+        }
+    }
+
+    void VirtualList::setContentSize(cocos2d::CCSize const& contentSize) {
+        CCLayer::setContentSize(contentSize);
+        if (m_content) {
+            this->setScrollOffset(m_scrollOffset);
+        }
+    }
+
+    void VirtualList::registerWithTouchDispatcher() {
+        cocos2d::CCDirector::get()->getTouchDispatcher()->addTargetedDelegate(this, 0, true);
+    }
+
+    bool VirtualList::ccTouchBegan(cocos2d::CCTouch* touch, cocos2d::CCEvent* event) {
+        if (!m_bVisible) return false;
+
+        auto point = this->convertTouchToNodeSpace(touch);
+        cocos2d::CCRect bounds(0.f, 0.f, m_obContentSize.width, m_obContentSize.height);
+        if (!bounds.containsPoint(point)) return false;
+
+        m_touching = true;
+        m_velocity = 0.f;
+        return true;
+    }
+
+    void VirtualList::ccTouchMoved(cocos2d::CCTouch* touch, cocos2d::CCEvent* event) {
+        auto delta = touch->getDelta().y;
+        this->setScrollOffset(m_scrollOffset + delta);
+
+        auto dt = cocos2d::CCDirector::get()->getDeltaTime();
+        m_velocity = delta / std::max(dt, 1.f / 240.f);
+    }
+
+    void VirtualList::ccTouchEnded(cocos2d::CCTouch* touch, cocos2d::CCEvent* event) {
+        m_touching = false;
+    }
+
+    void VirtualList::ccTouchCancelled(cocos2d::CCTouch* touch, cocos2d::CCEvent* event) {
+        m_touching = false;
+        m_velocity = 0.f;
+    }
+
+    void VirtualList::scrollWheel(float y, float x) {
+        if (!m_bVisible) return;
+
+        auto point = this->convertToNodeSpace(geode::cocos::getMousePos());
+        cocos2d::CCRect bounds(0.f, 0.f, m_obContentSize.width, m_obContentSize.height);
+        if (!bounds.containsPoint(point)) return;
+
+        m_velocity = 0.f;
+        this->setScrollOffset(m_scrollOffset + y);
+    }
+} // namespace rock
@@ -0,0 +1,224 @@
+// Converts text layouts into binary rock blueprints.
+//
+// Usage: rock-blueprint <input.txt> <output.rkb>
+//
+// Every line describes a single node, children are indented deeper than their parent:
+//
+//   # comment
+//   node size=400,300
+//     rect color=30,30,30,255 size=200,100 radii=40,20,60,10 pos=100,150
+//       sprite frame=groundSquare_15_001.png radii=10 pos=100,50 scale=0.5
+//
+// Node types: node, rect, sprite
+// Properties: pos=x,y  size=w,h  scale=s|sx,sy  rotation=deg  anchor=x,y
+//             color=r,g,b[,a]  radii=r|tl,tr,br,bl  z=order  tag=tag  frame=name
+
+#include <rock/BlueprintFormat.hpp>
+
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+using namespace rock::blueprint;
+
+struct ParsedNode {
+    NodeRecord record;
+    std::string frameName;
+    size_t indent = 0;
+};
+
+static std::vector<float> parseNumbers(std::string_view value) {
+    std::vector<float> numbers;
+    while (!value.empty()) {
+        auto comma = value.find(',');
+        auto part = value.substr(0, comma);
+
+        float number = 0.f;
+        auto [ptr, ec] = std::from_chars(part.data(), part.data() + part.size(), number);
+        if (ec != std::errc() || ptr != part.data() + part.size()) {
+            return {};
+        }
+        numbers.push_back(number);
+
+        if (comma == std::string_view::npos) break;
+        value.remove_prefix(comma + 1);
+    }
+    return numbers;
+}
+
+static std::optional<std::string> applyProperty(ParsedNode& node, std::string_view key, std::string_view value) {
+    auto& record = node.record;
+
+    if (key == "frame") {
+        node.frameName = value;
+        return std::nullopt;
+    }
+
+    auto numbers = parseNumbers(value);
+    if (numbers.empty()) {
+        return "invalid value '" + std::string(value) + "' for '" + std::string(key) + "'";
+    }
+
+    auto expect = [&](std::initializer_list<size_t> counts) -> std::optional<std::string> {
+        for (auto count : counts) {
+            if (numbers.size() == count) return std::nullopt;
+        }
+        return "wrong amount of values for '" + std::string(key) + "'";
+    };
+
+    if (key == "pos") {
+        if (auto err = expect({2})) return err;
+        record.x = numbers[0];
+        record.y = numbers[1];
+    } else if (key == "size") {
+        if (auto err = expect({2})) return err;
+        record.width = numbers[0];
+        record.height = numbers[1];
+    } else if (key == "scale") {
+        if (auto err = expect({1, 2})) return err;
+        record.scaleX = numbers[0];
+        record.scaleY = numbers.back();
+    } else if (key == "rotation") {
+        if (auto err = expect({1})) return err;
+        record.rotation = numbers[0];
+    } else if (key == "anchor") {
+        if (auto err = expect({2})) return err;
+        record.anchorX = numbers[0];
+        record.anchorY = numbers[1];
+    } else if (key == "color") {
+        if (auto err = expect({3, 4})) return err;
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            if (numbers[i] < 0.f || numbers[i] > 255.f) {
+                return "color components must be in 0-255 range";
+            }
+            record.color[i] = static_cast<uint8_t>(numbers[i]);
+        }
+    } else if (key == "radii") {
+        if (auto err = expect({1, 4})) return err;
+        for (size_t i = 0; i < 4; ++i) {
+            record.radii[i] = numbers.size() == 1 ? numbers[0] : numbers[i];
+        }
+    } else if (key == "z") {
+        if (auto err = expect({1})) return err;
+        record.zOrder = static_cast<int32_t>(numbers[0]);
+    } else if (key == "tag") {
+        if (auto err = expect({1})) return err;
+        record.tag = static_cast<int32_t>(numbers[0]);
+    } else {
+        return "unknown property '" + std::string(key) + "'";
+    }
+
+    return std::nullopt;
+}
+
+static std::optional<std::string> parseLine(std::string_view line, ParsedNode& node) {
+    std::istringstream stream{std::string(line)};
+    std::string type;
+    stream >> type;
+
+    if (type == "node") {
+        node.record.type = NodeType::Node;
+    } else if (type == "rect") {
+        node.record.type = NodeType::RoundedRect;
+    } else if (type == "sprite") {
+        node.record.type = NodeType::RoundedSprite;
+    } else {
+        return "unknown node type '" + type + "'";
+    }
+
+    std::string property;
+    while (stream >> property) {
+        auto equals = property.find('=');
+        if (equals == std::string::npos) {
+            return "expected key=value, got '" + property + "'";
+        }
+
+        std::string_view view = property;
+        if (auto err = applyProperty(node, view.substr(0, equals), view.substr(equals + 1))) {
+            return err;
+        }
+    }
+
+    if (node.record.type == NodeType::RoundedSprite && node.frameName.empty()) {
+        return "sprite requires a frame";
+    }
+
+    return std::nullopt;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <input.txt> <output.rkb>\n";
+        return 1;
+    }
+
+    std::ifstream input(argv[1]);
+    if (!input) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::vector<ParsedNode> nodes;
+    // indices of nodes that can still receive children, from the root down
+    std::vector<size_t> parents;
+
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(input, line); ++lineNumber) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        auto indent = line.find_first_not_of(' ');
+        if (indent == std::string::npos || line[indent] == '#') continue;
+        if (line[indent] == '\t') {
+            std::cerr << argv[1] << ":" << lineNumber << ": use spaces for indentation\n";
+            return 1;
+        }
+
+        ParsedNode node;
+        node.indent = indent;
+        if (auto err = parseLine(std::string_view(line).substr(indent), node)) {
+            std::cerr << argv[1] << ":" << lineNumber << ": " << *err << "\n";
+            return 1;
+        }
+
+        while (!parents.empty() && nodes[parents.back()].indent >= indent) {
+            parents.pop_back();
+        }
+
+        if (parents.empty() && !nodes.empty()) {
+            std::cerr << argv[1] << ":" << lineNumber << ": blueprint can only have one root node\n";
+            return 1;
+        }
+
+        if (!parents.empty()) {
+            nodes[parents.back()].record.childCount++;
+        }
+
+        parents.push_back(nodes.size());
+        nodes.push_back(std::move(node));
+    }
+
+    if (nodes.empty()) {
+        std::cerr << argv[1] << ": no nodes found\n";
+        return 1;
+    }
+
+    // lines are already in pre-order, which is what the format expects
+    Writer writer;
+    for (auto const& node : nodes) {
+        writer.addNode(node.record, node.frameName);
+    }
+    auto data = writer.finish();
+
+    std::ofstream output(argv[2], std::ios::binary);
+    output.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!output) {
+        std::cerr << "Failed to write " << argv[2] << "\n";
+        return 1;
+    }
+
+    std::cout << "Wrote " << nodes.size() << " nodes (" << data.size() << " bytes) to " << argv[2] << "\n";
+    return 0;
+}